@@ -0,0 +1,70 @@
+// Output capacity estimation for the streaming (_dr) converters on ASCII-heavy and CJK-heavy text.
+//
+// For each corpus prints the estimator's scan speed, the estimate and the previous fixed guess
+// (3x input for Big5 -> UTF-8, 2x for UTF-8 -> Big5) relative to the real output size, and the
+// conversion throughput and final capacity of the _dr converter.
+#include "utf8ansi.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(const Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string make_corpus(const char* unit, const std::size_t bytes) {
+    std::string out;
+    while (out.size() < bytes) out += unit;
+    return out;
+}
+
+template <class Convert>
+void report(const char* label, const std::string& input, const utf8ansi::Encoding& from,
+            const utf8ansi::Encoding& to, const std::size_t fixed_factor, Convert&& convert) {
+    constexpr int kRounds = 20;
+    std::size_t estimate = 0;
+    const auto scan_start = Clock::now();
+    for (int i = 0; i < kRounds; ++i) estimate += utf8ansi::estimate_output_size(input, from, to);
+    const double scan_seconds = seconds_since(scan_start) / kRounds;
+    estimate /= kRounds;
+
+    const auto convert_start = Clock::now();
+    const std::string out = convert(input);
+    const double convert_seconds = seconds_since(convert_start);
+
+    const double actual = static_cast<double>(out.size());
+    std::printf("%-26s scan %6.2f GB/s | estimate %5.3fx, fixed guess %5.3fx of output | "
+                "convert %6.1f MiB/s, capacity %5.3fx of output\n",
+                label, static_cast<double>(input.size()) / scan_seconds / 1e9, static_cast<double>(estimate) / actual,
+                static_cast<double>(input.size() * fixed_factor + 16) / actual,
+                static_cast<double>(input.size()) / (1 << 20) / convert_seconds,
+                static_cast<double>(out.capacity()) / actual);
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t kBytes = std::size_t{16} << 20;
+    const std::string ascii_heavy =
+        make_corpus("2024-05-01T12:00:00Z INFO request id=42 path=/api/v1/orders user=王小明 status=200\n", kBytes);
+    const std::string cjk_heavy =
+        make_corpus("資料結構與演算法是電腦科學的基礎課程，涵蓋陣列、鏈結串列、樹與圖。(Data 101)\n", kBytes);
+
+    const auto big5 = utf8ansi::Encoding::big5();
+    const auto utf8 = utf8ansi::Encoding::utf8();
+    for (const auto& [name, text] : {std::pair{"ASCII-heavy", &ascii_heavy}, std::pair{"CJK-heavy", &cjk_heavy}}) {
+        const std::string big5_text = utf8ansi::utf8_to_big5(*text);
+        std::string label = std::string(name) + " Big5->UTF-8";
+        report(label.c_str(), big5_text, big5, utf8, 3,
+               [](const std::string& in) { return utf8ansi::big5_to_utf8_dr(in); });
+        label = std::string(name) + " UTF-8->Big5";
+        report(label.c_str(), *text, utf8, big5, 2,
+               [](const std::string& in) { return utf8ansi::utf8_to_big5_dr(in); });
+    }
+    return 0;
+}
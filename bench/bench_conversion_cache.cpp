@@ -0,0 +1,74 @@
+// big5_to_utf8 with and without a ConversionCache on a Zipf-distributed workload.
+//
+// Models repetitive record fields: a fixed vocabulary of short Big5 values drawn with Zipf
+// skew s, so a few values dominate and a long tail appears rarely. Prints ns per lookup.
+#include "utf8ansi.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<std::string> make_vocabulary(const std::size_t size) {
+    static const char* const kParts[] = {"台北", "高雄", "台中", "新竹", "花蓮", "電子", "食品", "服飾", "已出貨", "處理中"};
+    std::vector<std::string> vocabulary;
+    vocabulary.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        std::string utf8 = std::string(kParts[i % 10]) + kParts[(i / 10) % 10] + std::to_string(i);
+        vocabulary.push_back(utf8ansi::utf8_to_big5(utf8));
+    }
+    return vocabulary;
+}
+
+std::vector<std::size_t> zipf_indices(const std::size_t vocabulary, const double s, const std::size_t count) {
+    std::vector<double> weights(vocabulary);
+    for (std::size_t k = 0; k < vocabulary; ++k) weights[k] = 1.0 / std::pow(static_cast<double>(k + 1), s);
+    std::discrete_distribution<std::size_t> distribution(weights.begin(), weights.end());
+    std::mt19937_64 rng(42);
+    std::vector<std::size_t> indices(count);
+    for (auto& index : indices) index = distribution(rng);
+    return indices;
+}
+
+template <class Fn>
+double ns_per_op(const std::vector<std::size_t>& indices, Fn&& fn) {
+    std::size_t sink = 0;
+    const auto start = Clock::now();
+    for (const auto index : indices) sink += fn(index);
+    const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    if (sink == 0) std::printf("unexpected empty output\n");
+    return ns / static_cast<double>(indices.size());
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t kVocabulary = 10000;
+    constexpr std::size_t kLookups = 1000000;
+    const auto vocabulary = make_vocabulary(kVocabulary);
+
+    for (const double s : {0.8, 1.0, 1.2}) {
+        const auto indices = zipf_indices(kVocabulary, s, kLookups);
+
+        const double uncached = ns_per_op(indices, [&](const std::size_t i) {
+            return utf8ansi::big5_to_utf8(vocabulary[i]).size();
+        });
+
+        for (const std::size_t budget : {std::size_t{64} << 10, std::size_t{4} << 20}) {
+            utf8ansi::ConversionCache cache(utf8ansi::ConversionCacheOptions{.max_bytes = budget});
+            const double cached = ns_per_op(indices, [&](const std::size_t i) {
+                return cache.big5_to_utf8(vocabulary[i])->size();
+            });
+            const auto stats = cache.stats();
+            std::printf("zipf s=%.1f  budget=%5zu KiB  uncached %7.1f ns  cached %7.1f ns  hit rate %5.1f%%  entries %zu\n",
+                        s, budget >> 10, uncached, cached, 100.0 * stats.hit_rate(), stats.entries);
+        }
+    }
+    return 0;
+}
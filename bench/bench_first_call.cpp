@@ -0,0 +1,65 @@
+// First-call vs steady-state conversion latency, with and without preload().
+//
+// Each encoding below is only ever touched by this benchmark, so its first conversion in the
+// process pays ICU's data loading. Run in a fresh process; numbers are wall-clock microseconds.
+#include "utf8ansi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double micros_since(const Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+double time_conversion(const std::string& utf8, const char* encoding) {
+    const auto start = Clock::now();
+    const std::string out = utf8ansi::from_utf8(utf8, encoding);
+    const double us = micros_since(start);
+    if (out.empty()) std::printf("unexpected empty output\n");
+    return us;
+}
+
+double steady_state_median(const std::string& utf8, const char* encoding) {
+    std::vector<double> samples(1000);
+    for (auto& sample : samples) sample = time_conversion(utf8, encoding);
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+} // namespace
+
+int main() {
+    const std::string chinese = "中文測試：資料結構與演算法";
+    const std::string japanese = "日本語のテキスト：データ構造";
+
+    // Cold: nothing loaded before the first call.
+    const double cold_first = time_conversion(chinese, "Big5");
+    const double cold_steady = steady_state_median(chinese, "Big5");
+    std::printf("Big5      cold first call: %10.1f us | steady-state median: %6.2f us\n", cold_first, cold_steady);
+
+    // Warm: preload pays the cost up front, the first request does not.
+    const auto preload_start = Clock::now();
+    utf8ansi::preload({"Shift_JIS"});
+    const double preload_us = micros_since(preload_start);
+    const double warm_first = time_conversion(japanese, "Shift_JIS");
+    const double warm_steady = steady_state_median(japanese, "Shift_JIS");
+    std::printf("Shift_JIS preload():       %10.1f us\n", preload_us);
+    std::printf("Shift_JIS warm first call: %10.1f us | steady-state median: %6.2f us\n", warm_first, warm_steady);
+
+    // Background warm-up overlapping other start-up work.
+    const auto async_start = Clock::now();
+    auto pending = utf8ansi::preload_async({"EUC-KR"});
+    const double launch_us = micros_since(async_start);
+    pending.get();
+    std::printf("EUC-KR    preload_async() launch: %5.1f us, completed after %10.1f us\n",
+                launch_us, micros_since(async_start));
+    std::printf("EUC-KR    warm first call: %10.1f us\n", time_conversion("한국어", "EUC-KR"));
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Page faults and throughput of very large conversions with and without huge pages.
+//
+// Converts a ~64 MiB Big5 document to UTF-8 with the streaming (big5_to_utf8_dr) and two-pass
+// (big5_to_utf8) converters, first on regular 4 KiB pages (huge pages disabled), then with the
+// default huge-page threshold, then through huge_page_resource() with the std::pmr overloads.
+// Page faults are the process's minor faults during the call (getrusage).
+#include "utf8ansi.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include <sys/resource.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long minor_faults() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+template <class Fn>
+void measure(const char* label, const std::size_t input_bytes, Fn&& fn) {
+    const long faults_before = minor_faults();
+    const auto start = Clock::now();
+    const std::size_t out_bytes = fn();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const long faults = minor_faults() - faults_before;
+    std::printf("%-34s %8.1f MiB/s  %8ld page faults  (%zu MiB out)\n", label,
+                static_cast<double>(input_bytes) / (1 << 20) / seconds, faults, out_bytes >> 20);
+}
+
+} // namespace
+
+int main() {
+    std::string utf8;
+    while (utf8.size() < (std::size_t{64} << 20)) utf8 += "大型檔案轉換測試：資料結構與演算法 large file conversion; ";
+    const std::string big5 = utf8ansi::utf8_to_big5(utf8);
+    const utf8ansi::HugePageOptions defaults = utf8ansi::huge_page_options();
+
+    for (const bool enabled : {false, true}) {
+        utf8ansi::set_huge_page_options(utf8ansi::HugePageOptions{enabled, defaults.threshold_bytes});
+        const char* suffix = enabled ? "huge pages" : "4 KiB pages";
+        std::string label = std::string("big5_to_utf8_dr, ") + suffix;
+        measure(label.c_str(), big5.size(), [&] { return utf8ansi::big5_to_utf8_dr(big5).size(); });
+        label = std::string("big5_to_utf8, ") + suffix;
+        measure(label.c_str(), big5.size(), [&] { return utf8ansi::big5_to_utf8(big5).size(); });
+    }
+
+    std::pmr::memory_resource* resource = utf8ansi::huge_page_resource();
+    measure("big5_to_utf8_dr, huge_page_resource", big5.size(),
+            [&] { return utf8ansi::big5_to_utf8_dr(big5, resource).size(); });
+    measure("big5_to_utf8, huge_page_resource", big5.size(),
+            [&] { return utf8ansi::big5_to_utf8(big5, resource).size(); });
+
+    utf8ansi::set_huge_page_options(defaults);
+    return 0;
+}
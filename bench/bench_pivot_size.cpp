@@ -0,0 +1,67 @@
+// Streaming throughput over pivot sizes and input sizes.
+//
+// For every input size, converts Big5 -> UTF-8 and UTF-8 -> Big5 with big5_to_utf8_dr /
+// utf8_to_big5_dr under each fixed pivot size and under the automatic choice (pivot_units = 0),
+// printing MiB/s (best of several runs) so the sweet spot can be picked per machine.
+#include "utf8ansi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <class Fn>
+double best_mib_per_s(const std::size_t bytes, Fn&& fn) {
+    // Repeat small inputs so every measurement covers at least ~16 MiB.
+    const std::size_t repeats = std::max<std::size_t>(1, (std::size_t{16} << 20) / std::max<std::size_t>(bytes, 1));
+    double best = 0;
+    for (int run = 0; run < 5; ++run) {
+        std::size_t sink = 0;
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < repeats; ++i) sink += fn().size();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (sink == 0) std::printf("unexpected empty output\n");
+        best = std::max(best, static_cast<double>(bytes * repeats) / (1 << 20) / seconds);
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<std::size_t> input_sizes{1 << 10, 16 << 10, 256 << 10, 4 << 20};
+    const std::vector<std::size_t> pivots{0, 64, 256, 1024, 4096, 16384, 65536};
+
+    std::printf("%-12s %-12s", "direction", "input");
+    for (const auto pivot : pivots) {
+        if (pivot == 0) std::printf(" %9s", "auto");
+        else std::printf(" %9zu", pivot);
+    }
+    std::printf("   (MiB/s, pivot in UTF-16 units)\n");
+
+    const utf8ansi::StreamingOptions saved = utf8ansi::streaming_options();
+    for (const auto size : input_sizes) {
+        std::string utf8;
+        while (utf8.size() < size) utf8 += "串流轉換效能測試 streaming pivot benchmark, ";
+        const std::string big5 = utf8ansi::utf8_to_big5(utf8);
+
+        std::printf("%-12s %-12zu", "Big5->UTF-8", big5.size());
+        for (const auto pivot : pivots) {
+            utf8ansi::set_streaming_options({pivot});
+            std::printf(" %9.1f", best_mib_per_s(big5.size(), [&] { return utf8ansi::big5_to_utf8_dr(big5); }));
+        }
+        std::printf("\n%-12s %-12zu", "UTF-8->Big5", utf8.size());
+        for (const auto pivot : pivots) {
+            utf8ansi::set_streaming_options({pivot});
+            std::printf(" %9.1f", best_mib_per_s(utf8.size(), [&] { return utf8ansi::utf8_to_big5_dr(utf8); }));
+        }
+        std::printf("\n");
+    }
+    utf8ansi::set_streaming_options(saved);
+    return 0;
+}
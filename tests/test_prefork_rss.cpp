@@ -0,0 +1,110 @@
+// Measures per-child memory growth in a pre-fork worker model.
+//
+// Lives in its own executable so the process is cold: the first child is forked before any
+// converter data has been loaded, the second after initialize(InitMode::prefork).
+#include <gtest/gtest.h>
+#include "utf8ansi.h"
+
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#if defined(__linux__)
+#include <fstream>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace utf8ansi;
+
+#if defined(__linux__)
+
+namespace {
+
+struct MemoryUsage {
+    long rss_kb = 0;
+    long private_kb = 0; // Private_Clean + Private_Dirty: pages not shared with the parent
+};
+
+MemoryUsage read_memory_usage() {
+    MemoryUsage usage;
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        long kb = 0;
+        fields >> key >> kb;
+        if (key == "Rss:") usage.rss_kb = kb;
+        if (key == "Private_Clean:" || key == "Private_Dirty:") usage.private_kb += kb;
+    }
+    return usage;
+}
+
+// The work a freshly forked worker does on its first requests.
+void worker_workload() {
+    const std::string s = "中文測試 Hello 「你好，世界！」";
+    for (const char* enc : {"Big5", "GBK", "EUC-KR", "Shift_JIS"}) {
+        try {
+            (void)from_utf8(s, enc);
+        } catch (const std::runtime_error&) {
+            // Not every sample character exists in every encoding; loading the converter is what counts.
+        }
+    }
+    (void)big5_to_utf8(utf8_to_big5("中文"));
+}
+
+// Forks a worker, runs the workload there and returns its memory growth.
+MemoryUsage measure_child_growth() {
+    int fds[2];
+    if (pipe(fds) != 0) return {};
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        const MemoryUsage before = read_memory_usage();
+        worker_workload();
+        const MemoryUsage after = read_memory_usage();
+        const MemoryUsage growth{after.rss_kb - before.rss_kb, after.private_kb - before.private_kb};
+        const auto written = write(fds[1], &growth, sizeof(growth));
+        _exit(written == sizeof(growth) ? 0 : 1);
+    }
+    close(fds[1]);
+    MemoryUsage growth;
+    const auto got = read(fds[0], &growth, sizeof(growth));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_EQ(got, static_cast<ssize_t>(sizeof(growth)));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    return growth;
+}
+
+} // namespace
+
+TEST(PreforkTest, WarmParentReducesPerChildMemory) {
+    if (!std::ifstream("/proc/self/smaps_rollup")) {
+        GTEST_SKIP() << "/proc/self/smaps_rollup not available";
+    }
+    const MemoryUsage cold = measure_child_growth();
+    initialize(InitMode::prefork, {"Big5", "GBK", "EUC-KR", "Shift_JIS"});
+    const MemoryUsage warm = measure_child_growth();
+
+    spdlog::info("child growth without prefork init: rss={} KiB private={} KiB", cold.rss_kb, cold.private_kb);
+    spdlog::info("child growth with prefork init:    rss={} KiB private={} KiB", warm.rss_kb, warm.private_kb);
+    // RSS also counts shared pages the child merely maps; private pages are what each worker costs.
+    EXPECT_LT(warm.private_kb, cold.private_kb);
+}
+
+#else
+
+TEST(PreforkTest, WarmParentReducesPerChildMemory) {
+    GTEST_SKIP() << "fork()/procfs measurement is Linux-only";
+}
+
+#endif
+
+TEST(PreforkTest, LazyModeValidatesNames) {
+    EXPECT_NO_THROW(initialize(InitMode::lazy, {"Big5", "UTF-8"}));
+    EXPECT_THROW(initialize(InitMode::lazy, {"INVALID-ENC"}), std::runtime_error);
+}
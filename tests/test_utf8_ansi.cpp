@@ -4,7 +4,17 @@
 #include <string>
 #include <stdexcept>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <memory_resource>
+#include <algorithm>
+#include <sstream>
+#include <ranges>
 #include <spdlog/spdlog.h>
+#include <unicode/ucnv.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace utf8ansi;
 
@@ -375,3 +385,1119 @@ TEST(EncodingTest, Equivalence_CStr_vs_StringView_Big5Helpers) {
     auto u_cs = big5_to_utf8(b_cs.c_str());
     EXPECT_EQ(u_cs, u_sv);
 }
+
+// Tests for pre-resolved Encoding handles
+TEST(EncodingHandleTest, ResolvesAliasesToSameInternedEncoding) {
+    Encoding a("Big5");
+    Encoding b("big5");
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.id(), b.id());
+    EXPECT_EQ(a, Encoding::big5());
+    EXPECT_FALSE(a.name().empty());
+    EXPECT_EQ(a.name().data()[a.name().size()], '\0');
+    EXPECT_FALSE(a == Encoding::utf8());
+}
+
+TEST(EncodingHandleTest, CapabilityFlags) {
+    const Encoding utf8 = Encoding::utf8();
+    EXPECT_TRUE(utf8.has(EncodingFlags::utf8));
+    EXPECT_TRUE(utf8.has(EncodingFlags::unicode | EncodingFlags::ascii_compatible));
+    EXPECT_FALSE(utf8.has(EncodingFlags::stateful));
+
+    const Encoding big5 = Encoding::big5();
+    EXPECT_TRUE(big5.has(EncodingFlags::ascii_compatible));
+    EXPECT_FALSE(big5.has(EncodingFlags::unicode));
+    EXPECT_EQ(big5.max_char_size(), 2);
+
+    EXPECT_TRUE(Encoding("ISO-8859-1").has(EncodingFlags::single_byte));
+    EXPECT_TRUE(Encoding("ISO-2022-JP").has(EncodingFlags::stateful));
+    EXPECT_FALSE(Encoding("UTF-16LE").has(EncodingFlags::ascii_compatible));
+}
+
+TEST(EncodingHandleTest, UnknownNameThrows) {
+    EXPECT_THROW({ Encoding e("INVALID-ENC"); (void)e; }, std::runtime_error);
+}
+
+TEST(EncodingHandleTest, OverloadsMatchStringOverloads) {
+    const std::string s = "「你好，世界！」（測試：中文、標點。）";
+    const Encoding big5("Big5");
+    const std::string b = from_utf8(s, big5);
+    EXPECT_EQ(b, from_utf8(s, "Big5"));
+    EXPECT_EQ(to_utf8(b, big5), s);
+    EXPECT_EQ(convert_encoding(b, big5, Encoding::utf8()), s);
+    EXPECT_THROW({ auto out = from_utf8(std::string("你好😀"), big5); (void)out; }, std::runtime_error);
+}
+
+TEST(EncodingHandleTest, KnownAliasesAgreeWithIcu) {
+    // Every spelling here is served by the compile-time alias table; it must land on the
+    // same converter ICU itself would open.
+    const std::vector<std::string> names = {
+        "UTF-8", "utf8", "Big5", "big5", "BIG-5", "windows-950", "x-big5", "csBig5", "CP950", "ibm-950",
+        "Big5-HKSCS", "Shift_JIS", "SJIS", "cp932", "windows-31j", "MS_Kanji", "EUC-JP", "EUC-KR",
+        "GBK", "cp936", "windows-936", "GB2312", "GB18030", "ISO-8859-1", "latin1", "US-ASCII", "ascii",
+        "windows-1252", "cp1252", "UTF-16", "UTF-16LE", "UTF-16BE"
+    };
+    for (const auto& name : names) {
+        UErrorCode status = U_ZERO_ERROR;
+        UConverter* conv = ucnv_open(name.c_str(), &status);
+        ASSERT_TRUE(U_SUCCESS(status)) << name;
+        const std::string icu_name = ucnv_getName(conv, &status);
+        ucnv_close(conv);
+        EXPECT_EQ(Encoding(name).name(), icu_name) << "alias: " << name;
+    }
+}
+
+TEST(EncodingHandleTest, UnknownAliasesAreMemoized) {
+    const Encoding a("KOI8-R");
+    const Encoding b("koi8_r");
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(to_utf8(std::string("\xF0"), "KOI8-R"), to_utf8(std::string("\xF0"), a));
+}
+
+// Converters are cloned from per-encoding prototypes
+TEST(PrototypeCloneTest, StatefulEncodingRoundTrip) {
+    // ISO-2022-JP converters carry shift state and clone into a larger buffer than table converters
+    const std::string s = "日本語テキスト abc";
+    const std::string jis = from_utf8(s, "ISO-2022-JP");
+    EXPECT_EQ(to_utf8(jis, "ISO-2022-JP"), s);
+    // A fresh clone must start in the initial shift state every call
+    EXPECT_EQ(from_utf8(s, "ISO-2022-JP"), jis);
+}
+
+TEST(PrototypeCloneTest, ConcurrentConversionsShareOnePrototype) {
+    const std::string s = "中文測試 Hello 「你好，世界！」";
+    const std::string expected = utf8_to_big5(s);
+    std::vector<std::thread> threads;
+    std::vector<int> failures(8, 0);
+    for (std::size_t t = 0; t < failures.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 200; ++i) {
+                if (utf8_to_big5(s) != expected || big5_to_utf8_dr(expected) != s) ++failures[t];
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    for (const int f : failures) EXPECT_EQ(f, 0);
+}
+
+// Pooled converter caching
+class ConverterPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override { set_converter_caching(ConverterCaching::pooled); }
+    void TearDown() override { set_converter_caching(ConverterCaching::clone); }
+};
+
+TEST_F(ConverterPoolTest, ReusesConvertersAndReportsStats) {
+    const Encoding big5 = Encoding::big5();
+    const auto before = converter_pool_stats(big5);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(big5_to_utf8(utf8_to_big5("中文測試")), "中文測試");
+    }
+    const auto after = converter_pool_stats(big5);
+    EXPECT_EQ((after.hits + after.misses) - (before.hits + before.misses), 100u);
+    EXPECT_GT(after.hits, before.hits);
+    EXPECT_GE(after.depth, 1u);
+    EXPECT_LE(after.depth, after.capacity);
+    EXPECT_GT(after.hit_rate(), 0.0);
+    spdlog::info("Big5 pool: hits={} misses={} discards={} depth={}/{}",
+                 after.hits, after.misses, after.discards, after.depth, after.capacity);
+}
+
+TEST_F(ConverterPoolTest, ReturnedConvertersAreReset) {
+    // A failed conversion leaves error state behind; the next checkout must not see it
+    EXPECT_THROW({ auto out = utf8_to_big5_dr(std::string("你好😀")); (void)out; }, std::runtime_error);
+    EXPECT_EQ(big5_to_utf8_dr(utf8_to_big5_dr("你好")), "你好");
+    const std::string jis = from_utf8("日本語", "ISO-2022-JP");
+    EXPECT_EQ(from_utf8("日本語", "ISO-2022-JP"), jis);
+}
+
+TEST_F(ConverterPoolTest, ConcurrentCheckouts) {
+    const std::string s = "中文測試 Hello 「你好，世界！」";
+    const std::string expected = utf8_to_big5(s);
+    std::vector<std::thread> threads;
+    std::vector<int> failures(16, 0);
+    for (std::size_t t = 0; t < failures.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 200; ++i) {
+                if (utf8_to_big5(s) != expected || big5_to_utf8_dr(expected) != s) ++failures[t];
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    for (const int f : failures) EXPECT_EQ(f, 0);
+    const auto stats = converter_pool_stats(Encoding::big5());
+    EXPECT_LE(stats.depth, stats.capacity);
+}
+
+// Eager warm-up
+TEST(PreloadTest, PreloadsKnownEncodings) {
+    EXPECT_NO_THROW(preload({"Big5", "UTF-8", "Shift_JIS"}));
+    EXPECT_EQ(big5_to_utf8(utf8_to_big5("中文")), "中文");
+}
+
+TEST(PreloadTest, UnknownEncodingThrows) {
+    EXPECT_THROW(preload({"Big5", "INVALID-ENC"}), std::runtime_error);
+    auto pending = preload_async({"INVALID-ENC"});
+    EXPECT_THROW(pending.get(), std::runtime_error);
+}
+
+TEST_F(ConverterPoolTest, PreloadFillsPool) {
+    auto pending = preload_async({"EUC-KR"});
+    pending.get();
+    const auto stats = converter_pool_stats(Encoding("EUC-KR"));
+    EXPECT_EQ(stats.depth, stats.capacity);
+    EXPECT_EQ(stats.misses, 0u);
+}
+
+// std::pmr support
+namespace {
+// Counts allocations routed through it, forwarding to an upstream resource.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+
+private:
+    void* do_allocate(std::size_t n, std::size_t align) override {
+        ++allocations;
+        bytes += n;
+        return upstream_->allocate(n, align);
+    }
+    void do_deallocate(void* p, std::size_t n, std::size_t align) override { upstream_->deallocate(p, n, align); }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource* upstream_;
+};
+} // namespace
+
+TEST(PmrTest, OutputAndScratchComeFromResource) {
+    const std::string s(200, 'x');
+    const std::string text = s + "「你好，世界！」（測試：中文、標點。）";
+    CountingResource counting(std::pmr::new_delete_resource());
+    const std::pmr::string big5 = utf8_to_big5(text, &counting);
+    EXPECT_EQ(big5.get_allocator().resource(), &counting);
+    // UTF-16 scratch + result
+    EXPECT_GE(counting.allocations, 2u);
+    EXPECT_EQ(std::string_view(big5), std::string_view(utf8_to_big5(text)));
+
+    const std::size_t before = counting.allocations;
+    const std::pmr::string round = big5_to_utf8_dr(big5, &counting);
+    EXPECT_GT(counting.allocations, before);
+    EXPECT_EQ(std::string_view(round), std::string_view(text));
+}
+
+TEST(PmrTest, MonotonicArenaWithoutUpstream) {
+    // Everything must fit in the arena; falling back to the heap would throw std::bad_alloc.
+    alignas(std::max_align_t) std::byte arena[16384];
+    std::pmr::monotonic_buffer_resource request_arena(arena, sizeof(arena), std::pmr::null_memory_resource());
+    const std::string text = "中文測試 Hello";
+    const auto big5 = from_utf8(text, Encoding::big5(), &request_arena);
+    const auto utf8 = to_utf8(big5, "Big5", &request_arena);
+    const auto utf8_dr = big5_to_utf8_dr(big5, &request_arena);
+    const auto same = convert_encoding(utf8, "UTF-8", "UTF-8", &request_arena);
+    EXPECT_EQ(std::string_view(utf8), text);
+    EXPECT_EQ(std::string_view(utf8_dr), text);
+    EXPECT_EQ(std::string_view(same), text);
+}
+
+TEST(PmrTest, NullResourceUsesDefault) {
+    const std::pmr::string out = big5_to_utf8(utf8_to_big5("中文"), nullptr);
+    EXPECT_EQ(out.get_allocator().resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(std::string_view(out), "中文");
+}
+
+// Per-thread scratch buffer reuse
+class ScratchBufferTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        saved_ = scratch_buffer_options();
+        release_thread_scratch_buffer();
+    }
+    void TearDown() override {
+        set_scratch_buffer_options(saved_);
+        release_thread_scratch_buffer();
+    }
+    ScratchBufferOptions saved_;
+};
+
+TEST_F(ScratchBufferTest, ReusesHighWaterBuffer) {
+    const std::string text(4096, 'a');
+    EXPECT_EQ(big5_to_utf8(text), text);
+    const auto first = scratch_buffer_stats();
+    EXPECT_GE(first.thread_bytes, text.size() * 2);
+    EXPECT_GE(first.total_bytes, first.thread_bytes);
+    EXPECT_GE(first.threads, 1u);
+
+    EXPECT_EQ(big5_to_utf8(text.substr(0, 1000)), text.substr(0, 1000));
+    const auto second = scratch_buffer_stats();
+    EXPECT_EQ(second.allocations, first.allocations);
+    EXPECT_EQ(second.reuses, first.reuses + 1);
+    EXPECT_EQ(second.thread_bytes, first.thread_bytes);
+
+    release_thread_scratch_buffer();
+    EXPECT_EQ(scratch_buffer_stats().thread_bytes, 0u);
+}
+
+TEST_F(ScratchBufferTest, InputsAboveCapAreNotRetained) {
+    ScratchBufferOptions options;
+    options.max_retained_bytes = 256;
+    set_scratch_buffer_options(options);
+    const std::string text(1000, 'b');
+    const auto before = scratch_buffer_stats();
+    EXPECT_EQ(utf8_to_big5(text), text);
+    const auto after = scratch_buffer_stats();
+    EXPECT_EQ(after.thread_bytes, 0u);
+    EXPECT_EQ(after.allocations, before.allocations + 1);
+}
+
+TEST_F(ScratchBufferTest, TrimsAfterRunOfSmallConversions) {
+    ScratchBufferOptions options;
+    options.trim_after_calls = 3;
+    set_scratch_buffer_options(options);
+    const std::string big(64 * 1024, 'c');
+    EXPECT_EQ(to_utf8(big, "ISO-8859-1"), big);
+    const std::size_t high_water = scratch_buffer_stats().thread_bytes;
+    // Above the stack fast-path threshold, below a quarter of the retained buffer
+    const std::string small(1000, 'd');
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(to_utf8(small, "ISO-8859-1"), small);
+    }
+    const std::size_t trimmed = scratch_buffer_stats().thread_bytes;
+    EXPECT_LT(trimmed, high_water);
+    EXPECT_GT(trimmed, 0u);
+    spdlog::info("scratch high-water={} bytes, after trim={} bytes", high_water, trimmed);
+}
+
+// Small-input fast path
+TEST(SmallInputTest, MatchesLargeInputPathAtBoundary) {
+    const std::string unit = "中文測試abc";
+    std::string text;
+    while (text.size() < 600) text += unit;
+    // Around the 256-byte fast-path threshold, results must not depend on which path ran.
+    for (std::size_t len : {0u, 1u, 24u, 255u, 256u, 257u, 300u}) {
+        std::string prefix = text.substr(0, len);
+        while (!prefix.empty() && (static_cast<unsigned char>(prefix.back()) & 0xC0) == 0x80) prefix.pop_back();
+        if (!prefix.empty() && static_cast<unsigned char>(prefix.back()) >= 0xC0) prefix.pop_back();
+        const std::string big5 = utf8_to_big5(prefix);
+        EXPECT_EQ(big5, utf8_to_big5_dr(prefix)) << len;
+        EXPECT_EQ(big5_to_utf8(big5), prefix) << len;
+        EXPECT_EQ(big5_to_utf8_dr(big5.c_str()), prefix) << len;
+    }
+}
+
+TEST(SmallInputTest, OutputLargerThanStackBufferFallsBack) {
+    // 256 ASCII bytes -> UTF-32 with BOM is 1028 bytes, more than the 1024-byte stack buffer
+    const std::string text(256, 'a');
+    const std::string utf32 = from_utf8(text, "UTF-32");
+    EXPECT_EQ(utf32.size(), 1028u);
+    EXPECT_EQ(to_utf8(utf32, "UTF-32"), text);
+}
+
+TEST(SmallInputTest, ErrorsStillThrow) {
+    EXPECT_THROW({ auto out = big5_to_utf8(std::string("\xA4")); (void)out; }, std::runtime_error);
+    EXPECT_THROW({ auto out = big5_to_utf8_dr(std::string("\xA4")); (void)out; }, std::runtime_error);
+    EXPECT_THROW({ auto out = utf8_to_big5("😀"); (void)out; }, std::runtime_error);
+}
+
+// In-place conversion
+TEST(InPlaceTest, Utf8ToBig5MatchesOutOfPlace) {
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += (i % 3 == 0) ? "ASCII text, " : "「你好，世界！」（測試：中文、標點。）";
+    const std::string expected = utf8_to_big5(text);
+    std::string buf = text;
+    utf8_to_big5_in_place(buf);
+    EXPECT_EQ(buf, expected);
+    EXPECT_EQ(big5_to_utf8(buf), text);
+}
+
+TEST(InPlaceTest, SupportedPairs) {
+    EXPECT_TRUE(can_convert_in_place(Encoding::utf8(), Encoding::big5()));
+    EXPECT_TRUE(can_convert_in_place(Encoding::utf8(), Encoding::utf8()));
+    EXPECT_TRUE(can_convert_in_place(Encoding::utf8(), Encoding("ISO-8859-1")));
+    EXPECT_TRUE(can_convert_in_place(Encoding::utf8(), Encoding("EUC-KR")));
+    EXPECT_FALSE(can_convert_in_place(Encoding::big5(), Encoding::utf8()));
+    EXPECT_FALSE(can_convert_in_place(Encoding::utf8(), Encoding("UTF-16LE")));
+    EXPECT_FALSE(can_convert_in_place(Encoding::utf8(), Encoding("ISO-2022-JP")));
+    EXPECT_FALSE(can_convert_in_place(Encoding::utf8(), Encoding("GB18030")));
+
+    std::string buf = utf8_to_big5("中文");
+    EXPECT_THROW(convert_in_place(buf, "Big5", "UTF-8"), std::invalid_argument);
+}
+
+TEST(InPlaceTest, OtherTargetsAndValidation) {
+    const std::string latin = "caf\xC3\xA9 na\xC3\xAFve";
+    std::string buf = latin;
+    convert_in_place(buf, "UTF-8", "ISO-8859-1");
+    EXPECT_EQ(buf, from_utf8(latin, "ISO-8859-1"));
+
+    std::string same = "中文 ok";
+    convert_in_place(same, Encoding::utf8(), Encoding::utf8());
+    EXPECT_EQ(same, "中文 ok");
+
+    std::string empty;
+    utf8_to_big5_in_place(empty);
+    EXPECT_TRUE(empty.empty());
+}
+
+TEST(InPlaceTest, ErrorClearsBuffer) {
+    std::string buf = "你好😀";
+    EXPECT_THROW(utf8_to_big5_in_place(buf), std::runtime_error);
+    EXPECT_TRUE(buf.empty());
+    std::string invalid("\xC0\xAF", 2);
+    EXPECT_THROW(convert_in_place(invalid, "UTF-8", "UTF-8"), std::runtime_error);
+}
+
+// Conversion cache
+TEST(ConversionCacheTest, HitsShareTheCachedResult) {
+    ConversionCache cache;
+    const std::string big5 = utf8_to_big5("台北市");
+    const auto first = cache.big5_to_utf8(big5);
+    const auto second = cache.big5_to_utf8(big5);
+    EXPECT_EQ(*first, "台北市");
+    EXPECT_EQ(first.get(), second.get());
+
+    // Same bytes under another encoding pair are a different entry.
+    const auto latin = cache.convert(big5, Encoding("ISO-8859-1"), Encoding::utf8());
+    EXPECT_NE(*latin, *first);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_GT(stats.bytes, 0u);
+    EXPECT_DOUBLE_EQ(stats.hit_rate(), 1.0 / 3.0);
+
+    cache.clear();
+    EXPECT_EQ(cache.stats().entries, 0u);
+    EXPECT_EQ(*first, "台北市"); // handed-out results outlive eviction
+}
+
+TEST(ConversionCacheTest, EvictsLeastRecentlyUsedWithinBudget) {
+    ConversionCache cache(ConversionCacheOptions{.max_bytes = 1024, .max_entry_bytes = 64, .shards = 1});
+    const auto hot = cache.utf8_to_big5("hot");
+    for (int i = 0; i < 100; ++i) {
+        (void)cache.utf8_to_big5("value " + std::to_string(i));
+        (void)cache.utf8_to_big5("hot");
+    }
+    const auto stats = cache.stats();
+    EXPECT_LE(stats.bytes, 1024u);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_EQ(stats.hits, 100u);
+    EXPECT_EQ(cache.utf8_to_big5("hot").get(), hot.get());
+}
+
+TEST(ConversionCacheTest, BypassesLargeInputsAndDoesNotCacheErrors) {
+    ConversionCache cache(ConversionCacheOptions{.max_bytes = 1 << 20, .max_entry_bytes = 8, .shards = 2});
+    EXPECT_EQ(*cache.utf8_to_big5("longer than eight bytes"), "longer than eight bytes");
+    EXPECT_EQ(cache.stats().bypasses, 1u);
+
+    EXPECT_THROW((void)cache.utf8_to_big5("😀"), std::runtime_error);
+    EXPECT_THROW((void)cache.utf8_to_big5("😀"), std::runtime_error);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST(ConversionCacheTest, ConcurrentLookups) {
+    ConversionCache cache(ConversionCacheOptions{.max_bytes = 64 << 10, .max_entry_bytes = 256, .shards = 4});
+    std::vector<std::string> values;
+    for (int i = 0; i < 32; ++i) values.push_back(utf8_to_big5("城市" + std::to_string(i)));
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                const auto& value = values[static_cast<std::size_t>(i * (t + 1)) % values.size()];
+                if (*cache.big5_to_utf8(value) != big5_to_utf8(value)) ++mismatches;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(cache.stats().entries, values.size());
+}
+
+// Shared-memory conversion cache
+class SharedCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        name_ = "/utf8ansi-test-" + std::to_string(getpid());
+        SharedConversionCache::remove(name_);
+    }
+    void TearDown() override { SharedConversionCache::remove(name_); }
+
+    std::string name_;
+};
+
+TEST_F(SharedCacheTest, ReusesConversionsAcrossProcesses) {
+    const std::string big5 = utf8_to_big5("高雄市前鎮區");
+    {
+        SharedConversionCache cache(name_, SharedConversionCacheOptions{.slots = 1024});
+        const pid_t child = fork();
+        ASSERT_GE(child, 0);
+        if (child == 0) {
+            SharedConversionCache child_cache(name_, SharedConversionCacheOptions{.slots = 1024});
+            const bool ok = child_cache.big5_to_utf8(big5) == "高雄市前鎮區" && child_cache.stats().stores == 1;
+            _exit(ok ? 0 : 1);
+        }
+        int status = 0;
+        ASSERT_EQ(waitpid(child, &status, 0), child);
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(WEXITSTATUS(status), 0);
+
+        EXPECT_EQ(cache.big5_to_utf8(big5), "高雄市前鎮區");
+        EXPECT_EQ(cache.stats().hits, 1u);
+        EXPECT_EQ(cache.stats().misses, 0u);
+    }
+    // The segment outlives its mappings until removed; a different geometry is rejected.
+    SharedConversionCache reopened(name_, SharedConversionCacheOptions{.slots = 1024});
+    EXPECT_EQ(reopened.big5_to_utf8(big5), "高雄市前鎮區");
+    EXPECT_EQ(reopened.stats().hits, 1u);
+    EXPECT_THROW(SharedConversionCache(name_, SharedConversionCacheOptions{.slots = 4096}), std::runtime_error);
+}
+
+TEST_F(SharedCacheTest, CollisionsAndOversizedEntriesStayCorrect) {
+    SharedConversionCache cache(name_, SharedConversionCacheOptions{.slots = 4});
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            const std::string utf8 = "商品" + std::to_string(i);
+            EXPECT_EQ(cache.utf8_to_big5(utf8), utf8_to_big5(utf8));
+        }
+    }
+    const std::string large(300, 'x');
+    EXPECT_EQ(cache.utf8_to_big5(large), large);
+    EXPECT_EQ(cache.stats().bypasses, 1u);
+    EXPECT_THROW((void)cache.utf8_to_big5("😀"), std::runtime_error);
+}
+
+TEST_F(SharedCacheTest, ConcurrentReadersAndWriters) {
+    SharedConversionCache cache(name_, SharedConversionCacheOptions{.slots = 16});
+    std::vector<std::string> values;
+    for (int i = 0; i < 64; ++i) values.push_back("狀態" + std::to_string(i));
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 5000; ++i) {
+                const auto& value = values[static_cast<std::size_t>(i * (2 * t + 1)) % values.size()];
+                if (cache.utf8_to_big5(value) != utf8_to_big5(value)) ++mismatches;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 20000u);
+}
+
+// Deferred conversion
+TEST(LazyConvertedTest, ConvertsOnFirstAccessOnly) {
+    const auto field = lazy_converted::from_big5(utf8_to_big5("處理中"));
+    EXPECT_FALSE(field.converted());
+    EXPECT_EQ(field.source(), utf8_to_big5("處理中"));
+    const std::string& first = field.get();
+    EXPECT_TRUE(field.converted());
+    EXPECT_EQ(first, "處理中");
+    EXPECT_EQ(&field.get(), &first);
+}
+
+TEST(LazyConvertedTest, InvalidSourceThrowsOnAccessNotConstruction) {
+    lazy_converted field("你好😀", Encoding::utf8(), Encoding::big5());
+    EXPECT_FALSE(field.converted());
+    EXPECT_THROW((void)field.get(), std::runtime_error);
+    EXPECT_TRUE(field.converted());
+    EXPECT_THROW((void)field.get(), std::runtime_error);
+}
+
+TEST(LazyConvertedTest, MoveKeepsStateAndResult) {
+    lazy_converted a("中文", Encoding::utf8(), Encoding::big5());
+    lazy_converted pending = std::move(a);
+    EXPECT_FALSE(pending.converted());
+    EXPECT_EQ(pending.get(), utf8_to_big5("中文"));
+
+    std::vector<lazy_converted> fields;
+    fields.push_back(std::move(pending));
+    EXPECT_TRUE(fields.front().converted());
+    EXPECT_EQ(fields.front().get(), utf8_to_big5("中文"));
+}
+
+TEST(LazyConvertedTest, ConcurrentFirstAccessConvertsOnce) {
+    for (int round = 0; round < 20; ++round) {
+        const auto field = lazy_converted::from_big5(utf8_to_big5(std::string(5000, 'a') + "台北"));
+        std::vector<const std::string*> seen(8);
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t < seen.size(); ++t) {
+            threads.emplace_back([&, t] { seen[t] = &field.get(); });
+        }
+        for (auto& thread : threads) thread.join();
+        for (const auto* result : seen) EXPECT_EQ(result, seen.front());
+        EXPECT_EQ(*seen.front(), std::string(5000, 'a') + "台北");
+    }
+}
+
+// Batch conversion
+TEST(BatchTest, DeduplicatesIdenticalInputs) {
+    const std::string taipei = utf8_to_big5("台北");
+    const std::string kaohsiung = utf8_to_big5("高雄");
+    const std::vector<std::string_view> column{taipei, kaohsiung, taipei, "", taipei, kaohsiung, ""};
+
+    const auto batch = convert_batch_deduplicated(column, Encoding::big5(), Encoding::utf8());
+    ASSERT_EQ(batch.size(), column.size());
+    EXPECT_EQ(batch.values.size(), 3u);
+    EXPECT_EQ(batch[0], "台北");
+    EXPECT_EQ(batch[5], "高雄");
+    EXPECT_EQ(batch[6], "");
+    EXPECT_EQ(batch.index[0], batch.index[4]);
+
+    const auto fanned = big5_to_utf8_batch(column);
+    const std::vector<std::string> expected{"台北", "高雄", "台北", "", "台北", "高雄", ""};
+    EXPECT_EQ(fanned, expected);
+}
+
+TEST(BatchTest, EmptyBatchAndErrors) {
+    EXPECT_TRUE(utf8_to_big5_batch({}).empty());
+    const std::vector<std::string_view> bad{"ok", "😀"};
+    EXPECT_THROW((void)utf8_to_big5_batch(bad), std::runtime_error);
+}
+
+// Output sinks
+TEST(SinkTest, EmitsFixedSizeBlocks) {
+    std::string text;
+    for (int i = 0; i < 3000; ++i) text += "測試資料 block ";
+    std::string collected;
+    std::vector<std::size_t> sizes;
+    utf8_to_big5_to(text, [&](std::span<const char> block) {
+        collected.append(block.data(), block.size());
+        sizes.push_back(block.size());
+    }, 4096);
+
+    EXPECT_EQ(collected, utf8_to_big5(text));
+    ASSERT_GT(sizes.size(), 1u);
+    for (std::size_t i = 0; i + 1 < sizes.size(); ++i) EXPECT_LE(sizes[i], 4096u);
+    EXPECT_GT(sizes.front(), 4000u);
+}
+
+TEST(SinkTest, SmallAndEmptyInputs) {
+    int calls = 0;
+    std::string collected;
+    auto sink = [&](std::span<const char> block) {
+        ++calls;
+        collected.append(block.data(), block.size());
+    };
+    big5_to_utf8_to("", sink);
+    EXPECT_EQ(calls, 0);
+    big5_to_utf8_to(utf8_to_big5("高雄"), sink);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(collected, "高雄");
+
+    collected.clear();
+    convert_encoding_to("café", Encoding::utf8(), Encoding("ISO-8859-1"), sink);
+    EXPECT_EQ(collected, "caf\xE9");
+}
+
+TEST(SinkTest, ErrorsPropagate) {
+    auto discard = [](std::span<const char>) {};
+    EXPECT_THROW(utf8_to_big5_to("ok 😀", discard), std::runtime_error);
+
+    struct Full {};
+    EXPECT_THROW(utf8_to_big5_to(std::string(10000, 'x'), [](std::span<const char>) { throw Full{}; }, 1024), Full);
+}
+
+TEST(SinkTest, BlockSizeBelowMinimumIsRejected) {
+    std::vector<std::size_t> sizes;
+    auto sink = [&](std::span<const char> block) { sizes.push_back(block.size()); };
+    EXPECT_THROW(utf8_to_big5_to("abc", sink, 0), std::invalid_argument);
+    EXPECT_THROW(utf8_to_big5_to("abc", sink, kMinSinkBlockSize - 1), std::invalid_argument);
+    EXPECT_TRUE(sizes.empty());
+
+    utf8_to_big5_to(std::string(1000, 'x'), sink, kMinSinkBlockSize);
+    ASSERT_FALSE(sizes.empty());
+    for (const std::size_t size : sizes) EXPECT_LE(size, kMinSinkBlockSize);
+}
+
+// Scatter-gather input
+TEST(FragmentsTest, CharactersSplitAcrossFragments) {
+    std::string text;
+    for (int i = 0; i < 500; ++i) text += "封包內容 payload ";
+    const std::string big5 = utf8_to_big5(text);
+
+    // Cut at every odd offset so that double-byte characters straddle fragment boundaries.
+    std::vector<std::span<const char>> fragments;
+    for (std::size_t pos = 0; pos < big5.size(); pos += 7) {
+        fragments.emplace_back(big5.data() + pos, std::min<std::size_t>(7, big5.size() - pos));
+    }
+    fragments.emplace_back(); // empty fragments are allowed anywhere
+    EXPECT_EQ(big5_to_utf8_dr(fragments), text);
+
+    std::string streamed;
+    convert_fragments_to(fragments, Encoding::big5(), Encoding::utf8(),
+                         [&](std::span<const char> block) { streamed.append(block.data(), block.size()); }, 512);
+    EXPECT_EQ(streamed, text);
+
+    std::vector<iovec> iov;
+    for (const auto& fragment : fragments) iov.push_back({const_cast<char*>(fragment.data()), fragment.size()});
+    EXPECT_EQ(convert_fragments(std::span<const iovec>(iov), Encoding::big5(), Encoding::utf8()), text);
+}
+
+TEST(FragmentsTest, EdgeCases) {
+    EXPECT_EQ(utf8_to_big5_dr(std::span<const std::span<const char>>()), "");
+
+    const std::string utf8 = "中";
+    const std::vector<std::span<const char>> truncated{{utf8.data(), 2}};
+    EXPECT_THROW((void)utf8_to_big5_dr(truncated), std::runtime_error);
+
+    const std::vector<std::span<const char>> split{{utf8.data(), 1}, {utf8.data() + 1, 2}};
+    EXPECT_EQ(utf8_to_big5_dr(split), utf8_to_big5("中"));
+
+    const std::string big5 = utf8_to_big5("中文");
+    const std::vector<std::span<const char>> null_fragment{{big5.data(), 2}, {static_cast<const char*>(nullptr), 100}};
+    EXPECT_THROW((void)convert_fragments(null_fragment, Encoding::big5(), Encoding::utf8()), std::invalid_argument);
+    EXPECT_THROW((void)big5_to_utf8_dr(null_fragment), std::invalid_argument);
+    const std::vector<std::span<const char>> null_empty{{big5.data(), big5.size()}, {}};
+    EXPECT_EQ(big5_to_utf8_dr(null_empty), "中文");
+}
+
+// Segmented output
+TEST(SegmentedOutputTest, LargeOutputSpansBlocks) {
+    std::string text;
+    while (text.size() < 3 * SegmentedOutput::kBlockSize) text += "分段輸出 segmented output ";
+    const std::string big5 = utf8_to_big5(text);
+
+    const SegmentedOutput out = big5_to_utf8_segmented(big5);
+    EXPECT_EQ(out.size(), text.size());
+    EXPECT_GE(out.blocks().size(), 3u);
+    std::size_t total = 0;
+    for (const auto& block : out.blocks()) {
+        EXPECT_FALSE(block.empty());
+        EXPECT_LE(block.size(), SegmentedOutput::kBlockSize);
+        total += block.size();
+    }
+    EXPECT_EQ(total, out.size());
+    EXPECT_EQ(out.str(), text);
+
+    const auto iov = out.iovecs();
+    ASSERT_EQ(iov.size(), out.blocks().size());
+    EXPECT_EQ(iov.front().iov_base, out.blocks().front().data());
+
+    // The blocks feed straight back into scatter-gather input.
+    EXPECT_EQ(utf8_to_big5_dr(out.blocks()), big5);
+}
+
+TEST(SegmentedOutputTest, BlocksAreReturnedToThePool) {
+    const void* first = nullptr;
+    {
+        const auto out = utf8_to_big5_segmented("回收");
+        ASSERT_EQ(out.blocks().size(), 1u);
+        first = out.blocks().front().data();
+    }
+    const auto again = utf8_to_big5_segmented("重用");
+    EXPECT_EQ(again.blocks().front().data(), first);
+    EXPECT_EQ(again.str(), utf8_to_big5("重用"));
+
+    SegmentedOutput moved = utf8_to_big5_segmented("abc");
+    SegmentedOutput target = std::move(moved);
+    EXPECT_TRUE(moved.empty());
+    EXPECT_EQ(target.str(), "abc");
+
+    EXPECT_TRUE(utf8_to_big5_segmented("").blocks().empty());
+    EXPECT_THROW((void)utf8_to_big5_segmented("😀"), std::runtime_error);
+}
+
+// Huge pages
+class HugePageTest : public ::testing::Test {
+protected:
+    void SetUp() override { saved_ = huge_page_options(); }
+    void TearDown() override { set_huge_page_options(saved_); }
+
+    HugePageOptions saved_;
+};
+
+TEST_F(HugePageTest, ResourceHandsOutAlignedMappings) {
+    std::pmr::memory_resource* resource = huge_page_resource();
+    ASSERT_NE(resource, nullptr);
+    EXPECT_TRUE(resource->is_equal(*huge_page_resource()));
+
+    void* large = resource->allocate(5u << 20, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % (2u << 20), 0u);
+    static_cast<char*>(large)[(5u << 20) - 1] = 'x';
+    resource->deallocate(large, 5u << 20, 64);
+
+    void* small = resource->allocate(100, 8);
+    resource->deallocate(small, 100, 8);
+
+    std::string text;
+    while (text.size() < (3u << 20)) text += "大型轉換 huge page ";
+    EXPECT_EQ(std::string_view(big5_to_utf8_dr(utf8_to_big5_dr(text, resource), resource)), text);
+}
+
+TEST_F(HugePageTest, LowThresholdKeepsResultsIdentical) {
+    set_huge_page_options(HugePageOptions{.enabled = true, .threshold_bytes = 1u << 20});
+    EXPECT_EQ(huge_page_options().threshold_bytes, 1u << 20u);
+
+    std::string text;
+    while (text.size() < (6u << 20)) text += "資料量很大的檔案 with ASCII ";
+    const std::string big5 = utf8_to_big5(text);
+    EXPECT_EQ(big5_to_utf8(big5), text);
+    EXPECT_EQ(big5_to_utf8_dr(big5), text);
+
+    set_huge_page_options(HugePageOptions{.enabled = false});
+    EXPECT_FALSE(huge_page_options().enabled);
+    EXPECT_EQ(big5_to_utf8_dr(big5), text);
+}
+
+// Mapped output
+TEST(MappedBufferTest, GrowsKeepingContents) {
+    MappedBuffer buf(100);
+    EXPECT_GE(buf.capacity(), 100u);
+    buf.resize(5);
+    std::copy_n("hello", 5, buf.data());
+    for (std::size_t cap = 1u << 12; cap <= (8u << 20); cap *= 2) buf.reserve(cap);
+    EXPECT_GE(buf.capacity(), 8u << 20);
+    EXPECT_EQ(buf.view(), "hello");
+
+    MappedBuffer moved = std::move(buf);
+    EXPECT_EQ(buf.data(), nullptr);
+    EXPECT_EQ(moved.str(), "hello");
+}
+
+TEST(MappedBufferTest, ConvertsIntoMappedBuffer) {
+    std::string text;
+    while (text.size() < (1u << 20)) text += "記憶體映射 mremap growth ";
+    const MappedBuffer big5 = utf8_to_big5_mapped(text);
+    EXPECT_EQ(big5.view(), utf8_to_big5(text));
+    EXPECT_EQ(big5_to_utf8_mapped(big5.view()).view(), text);
+    EXPECT_TRUE(utf8_to_big5_mapped("").empty());
+    EXPECT_THROW((void)utf8_to_big5_mapped("😀"), std::runtime_error);
+}
+
+// Memory budget
+TEST(MemoryBudgetTest, StreamingFitsGuessIntoBudget) {
+    std::string text;
+    while (text.size() < 300000) text += "預算 budget ";
+    const std::string big5 = utf8_to_big5(text);
+
+    const ScopedMemoryBudget scope(3 * text.size() / 2);
+    // The 3x initial guess alone would exceed the budget; it is clamped instead.
+    EXPECT_EQ(big5_to_utf8_dr(big5), text);
+}
+
+TEST(MemoryBudgetTest, ExceedingConversionsFailFast) {
+    std::string text;
+    while (text.size() < 300000) text += "預算 budget ";
+    const std::string big5 = utf8_to_big5(text);
+
+    const ScopedMemoryBudget scope(100000);
+    try {
+        (void)big5_to_utf8_dr(big5);
+        FAIL() << "expected MemoryBudgetExceeded";
+    } catch (const MemoryBudgetExceeded& e) {
+        EXPECT_EQ(e.budget(), 100000u);
+        EXPECT_GT(e.requested(), e.budget());
+    }
+    EXPECT_THROW((void)big5_to_utf8(big5), MemoryBudgetExceeded);
+    EXPECT_THROW((void)big5_to_utf8_segmented(big5), MemoryBudgetExceeded);
+    EXPECT_THROW((void)big5_to_utf8_mapped(big5), std::runtime_error); // MemoryBudgetExceeded is a runtime_error
+
+    // Bounded-memory sinks and small inputs are unaffected.
+    std::size_t streamed = 0;
+    big5_to_utf8_to(big5, [&](std::span<const char> block) { streamed += block.size(); });
+    EXPECT_EQ(streamed, text.size());
+    EXPECT_EQ(big5_to_utf8(utf8_to_big5("小")), "小");
+}
+
+TEST(MemoryBudgetTest, ProvenMinimumFailsBeforeConverting) {
+    std::string text;
+    while (text.size() < 300000) text += "預算 budget ";
+    const std::string big5 = utf8_to_big5(text);
+    const ScopedMemoryBudget scope(100000);
+
+    // Big5 to UTF-8 never shrinks, so the requested size is the input size: the check ran before
+    // any output was converted (a growth step would report a multiple of its capacity instead).
+    const auto requested = [](auto&& convert) -> std::size_t {
+        try {
+            (void)convert();
+        } catch (const MemoryBudgetExceeded& e) {
+            return e.requested();
+        }
+        return 0;
+    };
+    EXPECT_EQ(requested([&] { return big5_to_utf8_dr(big5); }), big5.size());
+    EXPECT_EQ(requested([&] { return big5_to_utf8_mapped(big5); }), big5.size());
+    EXPECT_EQ(requested([&] { return big5_to_utf8_segmented(big5); }), big5.size());
+    const std::vector<std::span<const char>> fragments{{big5.data(), 1001}, {big5.data() + 1001, big5.size() - 1001}};
+    EXPECT_EQ(requested([&] { return big5_to_utf8_dr(fragments); }), big5.size());
+
+    // UTF-8 sources: at least one byte per character.
+    std::size_t characters = 0;
+    for (const char c : text) characters += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    EXPECT_EQ(requested([&] { return utf8_to_big5_dr(text); }), characters);
+}
+
+TEST(MemoryBudgetTest, CoversSmallOutputsAndHeapPivot) {
+    const std::string small(200, 'x');
+    {
+        const ScopedMemoryBudget tight(100);
+        EXPECT_THROW((void)utf8_to_big5(small), MemoryBudgetExceeded);
+        EXPECT_THROW((void)utf8_to_big5_dr(small), MemoryBudgetExceeded);
+    }
+    {
+        const ScopedMemoryBudget enough(200);
+        EXPECT_EQ(utf8_to_big5(small), small);
+        EXPECT_EQ(utf8_to_big5_dr(small), small);
+    }
+
+    // A 64K-unit pivot takes 128 KiB of the budget before any output is allocated.
+    const StreamingOptions saved = streaming_options();
+    const std::string text(20000, 'x');
+    const ScopedMemoryBudget scope(100000);
+    EXPECT_EQ(utf8_to_big5_dr(text), text);
+    set_streaming_options(StreamingOptions{.pivot_units = std::size_t{1} << 16});
+    EXPECT_THROW((void)utf8_to_big5_dr(text), MemoryBudgetExceeded);
+    set_streaming_options(saved);
+}
+
+TEST(MemoryBudgetTest, GlobalBudgetAndNestedScopes) {
+    const std::size_t saved = memory_budget();
+    set_memory_budget(1000);
+    EXPECT_EQ(memory_budget(), 1000u);
+    const std::string large(5000, 'x');
+    EXPECT_THROW((void)utf8_to_big5_dr(large), MemoryBudgetExceeded);
+    {
+        const ScopedMemoryBudget unlimited(kUnlimitedMemoryBudget);
+        EXPECT_EQ(utf8_to_big5_dr(large), large);
+        {
+            const ScopedMemoryBudget tight(10);
+            EXPECT_THROW((void)utf8_to_big5(large), MemoryBudgetExceeded);
+        }
+        EXPECT_EQ(utf8_to_big5(large), large);
+    }
+    EXPECT_THROW((void)utf8_to_big5(large), MemoryBudgetExceeded);
+
+    // Other threads see only the global budget.
+    std::thread([&] {
+        const ScopedMemoryBudget unlimited(kUnlimitedMemoryBudget);
+        EXPECT_EQ(utf8_to_big5(large), large);
+    }).join();
+    set_memory_budget(saved);
+}
+
+// Output size estimation
+TEST(EstimateTest, TracksActualSizeForBig5AndUtf8) {
+    const std::vector<std::string> corpora{
+        std::string(1000, 'a'),
+        "台北市信義區市府路一號電話：（02）2720-8889",
+        [] { std::string s; for (int i = 0; i < 300; ++i) s += "Log entry " + std::to_string(i) + " 狀態:OK; "; return s; }(),
+        [] { std::string s; for (int i = 0; i < 300; ++i) s += "資料結構與演算法、作業系統、計算機網路。"; return s; }(),
+        "",
+    };
+    for (const auto& utf8 : corpora) {
+        const std::string big5 = utf8_to_big5(utf8);
+        const std::size_t to_utf8 = estimate_output_size(big5, Encoding::big5(), Encoding::utf8());
+        EXPECT_GE(to_utf8, utf8.size());
+        EXPECT_LE(to_utf8, utf8.size() + utf8.size() / 20 + 16);
+
+        const std::size_t to_big5 = estimate_output_size(utf8, Encoding::utf8(), Encoding::big5());
+        EXPECT_GE(to_big5, big5.size());
+        EXPECT_LE(to_big5, big5.size() + 16);
+    }
+    // Pairs without a model get the worst case.
+    EXPECT_EQ(estimate_output_size("abcd", Encoding("Shift_JIS"), Encoding("UTF-16LE")), 4u * 2u + 16u);
+}
+
+TEST(EstimateTest, CStyleStreamingOverloadsAreSizedByEstimate) {
+    std::string utf8;
+    for (int i = 0; i < 2000; ++i) utf8 += "Log entry " + std::to_string(i) + " 狀態:OK; ";
+    const std::string big5 = utf8_to_big5(utf8);
+
+    const std::string from_pointer = big5_to_utf8_dr(big5.c_str());
+    const std::string from_length = big5_to_utf8_dr(big5.data(), big5.size());
+    EXPECT_EQ(from_pointer, utf8);
+    EXPECT_EQ(from_length, utf8);
+    EXPECT_LE(from_pointer.capacity(), estimate_output_size(big5, Encoding::big5(), Encoding::utf8()));
+    EXPECT_LE(from_length.capacity(), estimate_output_size(big5, Encoding::big5(), Encoding::utf8()));
+
+    const std::string to_pointer = utf8_to_big5_dr(utf8.c_str());
+    const std::string to_length = utf8_to_big5_dr(utf8.data(), utf8.size());
+    EXPECT_EQ(to_pointer, big5);
+    EXPECT_EQ(to_length, big5);
+    EXPECT_LE(to_pointer.capacity(), estimate_output_size(utf8, Encoding::utf8(), Encoding::big5()));
+    EXPECT_LE(to_length.capacity(), estimate_output_size(utf8, Encoding::utf8(), Encoding::big5()));
+}
+TEST(EstimateTest, WordAndTailCountsAgreeAtEveryAlignment) {
+    std::string text;
+    for (int i = 0; i < 50; ++i) text += "a中b文c";
+    for (std::size_t pad = 0; pad < 9; ++pad) {
+        const std::string utf8 = std::string(pad, 'x') + text + std::string(8 - pad, 'y');
+        EXPECT_EQ(estimate_output_size(utf8, Encoding::utf8(), Encoding::big5()), utf8_to_big5(utf8).size() + 16);
+    }
+}
+
+// Streaming engine tuning
+TEST(StreamingOptionsTest, ResultsIndependentOfPivotSize) {
+    const StreamingOptions saved = streaming_options();
+    std::string text;
+    while (text.size() < 200000) text += "樞紐緩衝 pivot 測試, ";
+    const std::string big5 = utf8_to_big5(text);
+    const std::vector<std::span<const char>> fragments{{big5.data(), 333}, {big5.data() + 333, big5.size() - 333}};
+
+    for (const std::size_t units : {std::size_t{0}, std::size_t{1}, std::size_t{64}, std::size_t{4096},
+                                    std::size_t{1} << 20}) {
+        set_streaming_options(StreamingOptions{.pivot_units = units});
+        EXPECT_EQ(streaming_options().pivot_units, units);
+        EXPECT_EQ(big5_to_utf8_dr(big5), text) << units;
+        EXPECT_EQ(utf8_to_big5_dr(text), big5) << units;
+        EXPECT_EQ(big5_to_utf8_dr(fragments), text) << units;
+    }
+    set_streaming_options(saved);
+}
+
+// Asynchronous conversion
+TEST(AsyncTest, ConvertsOnWorkerPool) {
+    std::string text;
+    while (text.size() < 500000) text += "非同步附件轉換 attachment ";
+    const std::string big5 = utf8_to_big5(text);
+
+    std::vector<std::future<std::string>> pending;
+    for (int i = 0; i < 16; ++i) pending.push_back(big5_to_utf8_async(big5));
+    pending.push_back(utf8_to_big5_async(text));
+    for (int i = 0; i < 16; ++i) EXPECT_EQ(pending[static_cast<std::size_t>(i)].get(), text);
+    EXPECT_EQ(pending.back().get(), big5);
+
+    EXPECT_EQ(convert_async("café", Encoding::utf8(), Encoding("ISO-8859-1")).get(), "caf\xE9");
+}
+
+TEST(AsyncTest, ErrorsAndBudgetSurfaceFromGet) {
+    auto failed = utf8_to_big5_async("😀");
+    EXPECT_THROW((void)failed.get(), std::runtime_error);
+
+    const ScopedMemoryBudget scope(1000);
+    auto over_budget = utf8_to_big5_async(std::string(100000, 'x'));
+    EXPECT_THROW((void)over_budget.get(), MemoryBudgetExceeded);
+}
+
+// Chunk generators
+TEST(ChunkGeneratorTest, YieldsWholeOutputInBoundedChunks) {
+    std::string text;
+    while (text.size() < 100000) text += "協程逐塊轉換 chunk, ";
+    const std::string big5 = utf8_to_big5(text);
+
+    std::string joined;
+    std::size_t chunks = 0;
+    for (const std::span<const char> chunk : convert_chunks(big5, Encoding::big5(), Encoding::utf8(), 4096)) {
+        EXPECT_LE(chunk.size(), 4096u);
+        joined.append(chunk.data(), chunk.size());
+        ++chunks;
+    }
+    EXPECT_EQ(joined, text);
+    EXPECT_GT(chunks, 10u);
+
+    std::size_t empty_chunks = 0;
+    for ([[maybe_unused]] const auto chunk : convert_chunks("", Encoding::big5(), Encoding::utf8())) ++empty_chunks;
+    EXPECT_EQ(empty_chunks, 0u);
+}
+
+TEST(ChunkGeneratorTest, StreamInputStopsEarly) {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) text += "第" + std::to_string(i) + "行 line\n";
+    std::istringstream in(utf8_to_big5(text));
+
+    // Stop after the first three lines; the rest of the stream is never read.
+    std::string head;
+    for (const std::span<const char> chunk : convert_chunks(in, Encoding::big5(), Encoding::utf8(), 1024)) {
+        head.append(chunk.data(), chunk.size());
+        if (std::count(head.begin(), head.end(), '\n') >= 3) break;
+    }
+    EXPECT_EQ(head.substr(0, head.find("第3行")), "第0行 line\n第1行 line\n第2行 line\n");
+    EXPECT_LT(static_cast<std::size_t>(in.tellg()), 4096u);
+
+    std::istringstream whole(utf8_to_big5(text));
+    std::string joined;
+    for (const auto chunk : convert_chunks(whole, Encoding::big5(), Encoding::utf8(), 1000)) {
+        joined.append(chunk.data(), chunk.size());
+    }
+    EXPECT_EQ(joined, text);
+}
+
+TEST(ChunkGeneratorTest, ErrorsSurfaceWhilePulling) {
+    const std::string text = std::string(10000, 'a') + "😀";
+    auto generator = convert_chunks(text, Encoding::utf8(), Encoding::big5(), 1024);
+    EXPECT_THROW(
+        {
+            for ([[maybe_unused]] const auto chunk : generator) {
+            }
+        },
+        std::runtime_error);
+}
+
+TEST(ChunkGeneratorTest, ChunkSizeBelowMinimumIsRejectedEagerly) {
+    std::istringstream in("abc");
+    EXPECT_THROW((void)convert_chunks("abc", Encoding::utf8(), Encoding::big5(), 16), std::invalid_argument);
+    EXPECT_THROW((void)convert_chunks(in, Encoding::utf8(), Encoding::big5(), 0), std::invalid_argument);
+
+    const std::string text(1000, 'x');
+    std::size_t largest = 0;
+    for (const auto chunk : convert_chunks(text, Encoding::utf8(), Encoding::big5(), kMinSinkBlockSize)) {
+        largest = std::max(largest, chunk.size());
+    }
+    EXPECT_EQ(largest, kMinSinkBlockSize);
+}
+
+// Lazy transcoding views
+TEST(TranscodeViewTest, ConvertsContiguousAndInputRanges) {
+    std::string text;
+    while (text.size() < 50000) text += "檢視轉碼 view, ";
+    const std::string big5 = utf8_to_big5(text);
+
+    static_assert(std::ranges::input_range<decltype(std::string_view(big5) | views::transcode(Encoding::big5(),
+                                                                                               Encoding::utf8()))>);
+    std::string out;
+    for (const char c : std::string_view(big5) | views::transcode(Encoding::big5(), Encoding::utf8())) out += c;
+    EXPECT_EQ(out, text);
+
+    // A non-contiguous byte source is staged block by block.
+    std::istringstream in(big5);
+    std::string staged;
+    for (const char c : views::transcode(std::views::istream<char>(in >> std::noskipws), Encoding::big5(),
+                                         Encoding::utf8())) {
+        staged += c;
+    }
+    EXPECT_EQ(staged, text);
+
+    std::string empty;
+    for (const char c : std::string_view() | views::transcode(Encoding::big5(), Encoding::utf8())) empty += c;
+    EXPECT_TRUE(empty.empty());
+}
+
+TEST(TranscodeViewTest, ComposesWithStandardViews) {
+    std::string text;
+    for (int i = 0; i < 5000; ++i) text += "第" + std::to_string(i) + "行\n";
+    const std::string big5 = utf8_to_big5(text);
+
+    std::string head;
+    for (const char c :
+         std::string_view(big5) | views::transcode(Encoding::big5(), Encoding::utf8()) | std::views::take(8)) {
+        head += c;
+    }
+    EXPECT_EQ(head, text.substr(0, 8));
+
+    std::vector<std::string> lines;
+    for (const auto line : std::string_view(big5) | views::transcode(Encoding::big5(), Encoding::utf8())
+                               | std::views::lazy_split('\n') | std::views::take(3)) {
+        std::string current;
+        for (const char c : line) current += c;
+        lines.push_back(current);
+    }
+    EXPECT_EQ(lines, (std::vector<std::string>{"第0行", "第1行", "第2行"}));
+}
+
+TEST(TranscodeViewTest, ErrorsSurfaceWhileIterating) {
+    const std::string text = std::string(10000, 'a') + "😀";
+    auto view = std::string_view(text) | views::transcode(Encoding::utf8(), Encoding::big5());
+    EXPECT_THROW(
+        {
+            for ([[maybe_unused]] const char c : view) {
+            }
+        },
+        std::runtime_error);
+}
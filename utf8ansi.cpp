@@ -1,18 +1,80 @@
 #include "utf8ansi.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <iterator>
 #include <limits>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <istream>
+#include <shared_mutex>
+#include <unordered_map>
+#include <functional>
+#include <array>
+#include <bit>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <memory_resource>
 
 #include <unicode/ucnv.h>
+#include <unicode/uset.h>
+#include <unicode/utf16.h>
 
 namespace utf8ansi {
 
+namespace detail {
+
+class ConverterPool;
+
+// Interned, immutable description of a resolved encoding. Records are owned by the
+// process-wide registry and never destroyed, so Encoding can refer to them by pointer.
+struct EncodingRecord {
+    std::string canonical_name;
+    std::uint32_t id{0};
+    EncodingFlags flags{EncodingFlags::none};
+    int max_char_size{0};
+    // Fully configured converter (STOP callbacks set) that instances are cloned from.
+    // Never used for conversion itself, so concurrent ucnv_safeClone calls on it are safe.
+    UConverter* prototype{nullptr};
+    // Created on first pooled use; never destroyed.
+    mutable std::atomic<ConverterPool*> pool{nullptr};
+};
+
+} // namespace detail
+
 namespace {
 
+constexpr std::string_view kUtf8Name = "UTF-8";
+constexpr std::string_view kBig5Name = "Big5";
+
 /**
  * Safely convert std::size_t to int32_t for ICU APIs.
  * Throws std::runtime_error if the size exceeds INT32_MAX.
@@ -64,8 +126,20 @@ struct UConverterHandle {
     UConverterHandle(UConverterHandle&&) = delete;
     UConverterHandle& operator=(UConverterHandle&&) = delete;
     explicit UConverterHandle(const std::string_view name) {
+        open(std::string(name).c_str(), name);
+    }
+    ~UConverterHandle() {
+        if (conv) ucnv_close(conv);
+    }
+    // Accessor for the underlying ICU handle; ownership remains with this wrapper.
+    [[nodiscard]] UConverter* get() const { return conv; }
+    // Transfers ownership of the converter to the caller.
+    [[nodiscard]] UConverter* release() { return std::exchange(conv, nullptr); }
+
+private:
+    void open(const char* c_name, const std::string_view name) {
         UErrorCode status = U_ZERO_ERROR;
-        conv = ucnv_open(std::string(name).c_str(), &status);
+        conv = ucnv_open(c_name, &status);
         if (U_FAILURE(status) || conv == nullptr) {
             throw std::runtime_error("Failed to open ICU converter: " + std::string(name));
         }
@@ -81,281 +155,2830 @@ struct UConverterHandle {
             throw std::runtime_error("Failed to set ICU FROM-UNICODE callback to STOP for: " + std::string(name));
         }
     }
-    ~UConverterHandle() {
-        if (conv) ucnv_close(conv);
-    }
-    // Accessor for the underlying ICU handle; ownership remains with this wrapper.
-    [[nodiscard]] UConverter* get() const { return conv; }
 };
 
-/**
- * Core conversion implementation using ICU in two pass preflight+convert steps:
- * 1) Source bytes -> UTF-16 (UChar) via ucnv_toUChars (preflight to size, then actual convert).
- * 2) UTF-16 -> target bytes via ucnv_fromUChars (preflight to size, then actual convert).
- *
- * Parameters:
- * - input: pointer to the source byte sequence; must not be null.
- * - length: number of bytes in input. Use -1 to indicate NUL-terminated input (ICU convention).
- * - from_encoding: ICU canonical or alias name of the source encoding.
- * - to_encoding: ICU canonical or alias name of the destination encoding.
- *
- * Throws std::invalid_argument if input is null.
- * Throws std::runtime_error on ICU errors during either phase.
- * Returns the converted bytes without a terminating NUL.
- */
-std::string convert_encoding_impl(const char* input,
-                                  const int32_t length,
-                                  const std::string_view from_encoding,
-                                  const std::string_view to_encoding) {
-    if (input == nullptr) {
-        if (length == 0) {
-            return {};
-        }
-        throw std::invalid_argument("convert_encoding: input is null");
-    }
+// Name used in error messages for either kind of encoding argument.
+std::string_view encoding_label(const std::string_view name) { return name; }
+std::string_view encoding_label(const Encoding& encoding) { return encoding.name(); }
 
-    const UConverterHandle from(from_encoding);
-    const UConverterHandle to(to_encoding);
+// Canonical ICU name of an open converter.
+std::string_view converter_name(const UConverter* conv) {
+    UErrorCode status = U_ZERO_ERROR;
+    const char* name = ucnv_getName(conv, &status);
+    if (U_FAILURE(status) || name == nullptr) {
+        throw std::runtime_error("Failed to query ICU converter name");
+    }
+    return name;
+}
 
-    // Step 1: Convert from source bytes to UTF-16 (UChar)
+/**
+ * Fill in name, size and capability flags of `rec` from an open converter.
+ * ASCII compatibility is probed by round-tripping 0x00-0x7F, which also rejects
+ * encodings that need shift sequences or byte order marks around ASCII text.
+ */
+void describe_converter(UConverter* conv, detail::EncodingRecord& rec) {
     UErrorCode status = U_ZERO_ERROR;
-    const int32_t uLen = ucnv_toUChars(from.get(), nullptr, 0, input, length, &status);
-    if (status != U_BUFFER_OVERFLOW_ERROR && U_FAILURE(status)) {
-        throw std::runtime_error("ICU preflight toUChars failed for encoding: " + std::string(from_encoding));
+    rec.canonical_name = converter_name(conv);
+    rec.max_char_size = ucnv_getMaxCharSize(conv);
+
+    EncodingFlags flags = EncodingFlags::none;
+    switch (ucnv_getType(conv)) {
+        case UCNV_UTF8:
+            flags = flags | EncodingFlags::unicode | EncodingFlags::utf8;
+            break;
+        case UCNV_UTF16_BigEndian:
+        case UCNV_UTF16_LittleEndian:
+        case UCNV_UTF32_BigEndian:
+        case UCNV_UTF32_LittleEndian:
+        case UCNV_UTF16:
+        case UCNV_UTF32:
+        case UCNV_CESU8:
+            flags = flags | EncodingFlags::unicode;
+            break;
+        case UCNV_UTF7:
+        case UCNV_IMAP_MAILBOX:
+        case UCNV_SCSU:
+        case UCNV_BOCU1:
+            flags = flags | EncodingFlags::unicode | EncodingFlags::stateful;
+            break;
+        case UCNV_EBCDIC_STATEFUL:
+        case UCNV_ISO_2022:
+        case UCNV_HZ:
+        case UCNV_ISCII:
+            flags = flags | EncodingFlags::stateful;
+            break;
+        default:
+            break;
     }
-    status = U_ZERO_ERROR;
-    std::vector<UChar> ubuf(static_cast<size_t>(uLen) + 1u);
-    const int32_t uWritten = ucnv_toUChars(from.get(), ubuf.data(), uLen + 1, input, length, &status);
-    if (U_FAILURE(status)) {
-        throw std::runtime_error("ICU toUChars failed for encoding: " + std::string(from_encoding));
+    if (rec.max_char_size == 1) {
+        flags = flags | EncodingFlags::single_byte;
     }
 
-    // Step 2: Convert from UTF-16 (UChar) to target bytes
+    char ascii[128];
+    for (int i = 0; i < 128; ++i) ascii[i] = static_cast<char>(i);
+    UChar units[256];
+    char back[512];
+    ucnv_reset(conv);
     status = U_ZERO_ERROR;
-    const int32_t outLen = ucnv_fromUChars(to.get(), nullptr, 0, ubuf.data(), uWritten, &status);
-    if (status != U_BUFFER_OVERFLOW_ERROR && U_FAILURE(status)) {
-        throw std::runtime_error("ICU preflight fromUChars failed for encoding: " + std::string(to_encoding));
+    const int32_t uLen = ucnv_toUChars(conv, units, std::size(units), ascii, std::size(ascii), &status);
+    bool ascii_compatible = U_SUCCESS(status) && uLen == 128;
+    for (int i = 0; ascii_compatible && i < 128; ++i) {
+        ascii_compatible = units[i] == static_cast<UChar>(i);
     }
-    status = U_ZERO_ERROR;
-    std::string out;
-    out.resize(static_cast<size_t>(outLen));
-    const int32_t written = ucnv_fromUChars(to.get(), out.data(), outLen, ubuf.data(), uWritten, &status);
-    if (U_FAILURE(status)) {
-        throw std::runtime_error("ICU fromUChars failed for encoding: " + std::string(to_encoding));
+    if (ascii_compatible) {
+        status = U_ZERO_ERROR;
+        const int32_t bLen = ucnv_fromUChars(conv, back, std::size(back), units, uLen, &status);
+        ascii_compatible = U_SUCCESS(status) && bLen == 128
+            && std::char_traits<char>::compare(back, ascii, 128) == 0;
     }
-    // No need to resize; ICU wrote exactly 'written' bytes, which should equal outLen
-    // but to be safe, adjust when different
-    if (written >= 0 && written < outLen) {
-        out.resize(static_cast<size_t>(written));
+    ucnv_reset(conv);
+    if (ascii_compatible) {
+        flags = flags | EncodingFlags::ascii_compatible;
     }
+    rec.flags = flags;
+}
 
-    return out;
+struct TransparentStringHash {
+    using is_transparent = void;
+    std::size_t operator()(const std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+};
+
+/**
+ * Fold an encoding name the way ICU's alias matching does for simple names:
+ * ASCII letters are lower-cased and '-', '_' and ' ' are dropped ("Big5" == "BIG-5" == "big5").
+ * Writes at most `capacity` bytes to `out` and returns the folded length, or -1 when the name
+ * contains other characters (options such as "UTF-8,swaplfnl") or does not fit.
+ */
+constexpr int fold_encoding_name(const std::string_view name, char* out, const std::size_t capacity) {
+    std::size_t n = 0;
+    for (const char c : name) {
+        if (c == '-' || c == '_' || c == ' ') continue;
+        char folded = c;
+        if (c >= 'A' && c <= 'Z') {
+            folded = static_cast<char>(c - 'A' + 'a');
+        } else if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))) {
+            return -1;
+        }
+        if (n == capacity) return -1;
+        out[n++] = folded;
+    }
+    return static_cast<int>(n);
 }
 
 /**
- * Streaming conversion using ICU ucnv_convertEx to avoid allocating a full UTF-16 buffer.
- *
- * This function converts incrementally through a small UTF-16 pivot buffer, growing the
- * output buffer as needed. Converters are configured to STOP on errors; any invalid input
- * results in an exception rather than silent substitution.
- *
- * Parameters:
- * - input: the source bytes to convert.
- * - from_encoding: ICU name (canonical or alias) of the source encoding.
- * - to_encoding: ICU name (canonical or alias) of the target encoding.
- * - initial_out_capacity: heuristic initial size for the output buffer; it will expand if required.
- *
- * Returns the converted bytes.
- * Throws std::invalid_argument if input.data() is null while input.size() != 0.
- * Throws std::runtime_error on ICU conversion errors.
+ * Process-wide intern table for resolved encodings, doubling as the prototype converter registry:
+ * each record owns one configured converter that ConverterInstance clones from.
+ * Every alias ever requested is memoized under its folded spelling, so each distinct name
+ * hits ICU once; later lookups only take a shared lock. Records are never freed; the registry
+ * itself is intentionally leaked so Encoding values stay valid during static destruction.
  */
-std::string convert_encoding_streaming(const std::string_view input,
-                                              const std::string_view from_encoding,
-                                              const std::string_view to_encoding,
-                                              const std::size_t initial_out_capacity) {
-    if (input.data() == nullptr && !input.empty()) {
-        throw std::invalid_argument("convert_encoding_streaming: input is null but size != 0");
+class EncodingRegistry {
+public:
+    static EncodingRegistry& instance() {
+        static auto* registry = new EncodingRegistry();
+        return *registry;
     }
 
-    const UConverterHandle from(from_encoding);
-    const UConverterHandle to(to_encoding);
+    const detail::EncodingRecord& resolve(const std::string_view name) {
+        char buf[64];
+        const int folded = fold_encoding_name(name, buf, sizeof(buf));
+        const std::string_view key = folded > 0 ? std::string_view(buf, static_cast<std::size_t>(folded)) : name;
+        {
+            std::shared_lock lock(mutex_);
+            if (const auto it = by_alias_.find(key); it != by_alias_.end()) {
+                return *it->second;
+            }
+        }
+        std::lock_guard lock(mutex_);
+        if (const auto it = by_alias_.find(key); it != by_alias_.end()) {
+            return *it->second;
+        }
+        UConverterHandle probe(name);
+        const detail::EncodingRecord* rec = nullptr;
+        if (const auto it = by_canonical_.find(converter_name(probe.get())); it != by_canonical_.end()) {
+            rec = it->second;
+        } else {
+            auto& fresh = records_.emplace_back();
+            try {
+                describe_converter(probe.get(), fresh);
+            } catch (...) {
+                records_.pop_back();
+                throw;
+            }
+            // The probe is already opened and configured, so it becomes the prototype.
+            fresh.id = static_cast<std::uint32_t>(records_.size() - 1);
+            fresh.prototype = probe.release();
+            by_canonical_.emplace(fresh.canonical_name, &fresh);
+            rec = &fresh;
+        }
+        by_alias_.emplace(std::string(key), rec);
+        return *rec;
+    }
 
-    // Prepare output buffer with a heuristic initial capacity.
-    std::string out;
-    std::size_t cap = initial_out_capacity;
-    if (cap < 16) cap = 16;
-    out.resize(cap);
-    char* target = out.data();
-    const char* targetLimit = out.data() + out.size();
+private:
+    EncodingRegistry() = default;
 
-    const char* source = input.data();
-    const char* const sourceLimit = input.data() + input.size();
+    std::shared_mutex mutex_;
+    std::deque<detail::EncodingRecord> records_;
+    std::unordered_map<std::string, const detail::EncodingRecord*, TransparentStringHash, std::equal_to<>> by_canonical_;
+    std::unordered_map<std::string, const detail::EncodingRecord*, TransparentStringHash, std::equal_to<>> by_alias_;
+};
 
-    // Small pivot buffer for UTF-16 code units used internally by ICU.
-    UChar pivot[256];
-    UChar* pivotSource = pivot;
-    UChar* pivotTarget = pivot;
+// -----------------------------------------------------------------------------
+// Compile-time perfect hash over common encoding names.
+//
+// Folded aliases of frequently used encodings map to a fixed slot; each slot lazily
+// caches its registry record, so string-based calls with these names skip both ICU's
+// alias table and the registry lock. Anything else goes through EncodingRegistry.
+// -----------------------------------------------------------------------------
 
-    bool reset = true;
+// Primary ICU name of each known slot, used to resolve the slot on first use.
+constexpr std::array<std::string_view, 16> kKnownEncodings{
+    "UTF-8", "Big5", "CP950", "Big5-HKSCS", "Shift_JIS", "EUC-JP", "EUC-KR", "GBK",
+    "GB2312", "GB18030", "ISO-8859-1", "US-ASCII", "windows-1252", "UTF-16", "UTF-16LE", "UTF-16BE",
+};
 
-    for (;;) {
-        UErrorCode status = U_ZERO_ERROR;
-        const UBool flush = (source == sourceLimit) ? 1 : 0;
-        ucnv_convertEx(
-            /*targetCnv*/ to.get(),
-            /*sourceCnv*/ from.get(),
-            /*target*/ &target,
-            /*targetLimit*/ targetLimit,
-            /*source*/ &source,
-            /*sourceLimit*/ sourceLimit,
-            /*pivotStart*/ pivot,
-            /*pivotSource*/ &pivotSource,
-            /*pivotTarget*/ &pivotTarget,
-            /*pivotLimit*/ pivot + std::size(pivot),
-            /*reset*/ reset ? 1 : 0,
-            /*flush*/ flush,
-            /*status*/ &status);
-        reset = false;
-
-        if (status == U_BUFFER_OVERFLOW_ERROR) {
-            // Grow the output buffer and continue.
-            const auto used = static_cast<std::size_t>(target - out.data());
-            const std::size_t newCap = safe_add(safe_multiply(out.size(), 2u), 16u);
-            out.resize(newCap);
-            target = out.data() + used;
-            targetLimit = out.data() + out.size();
-            continue;
-        }
-        if (U_FAILURE(status)) {
-            throw std::runtime_error(
-                std::string("ICU ucnv_convertEx failed for ") + std::string(from_encoding) + " -> " + std::string(to_encoding));
-        }
-        if (flush) {
-            break; // all input consumed and pivot drained
-        }
-        // else, loop continues to consume remaining input
-    }
-
-    out.resize(static_cast<std::size_t>(target - out.data()));
-    return out;
-}
+struct KnownAlias {
+    std::string_view folded;
+    std::uint8_t slot;
+};
 
-} // namespace
+// Folded spellings only; every entry must resolve in ICU to its slot's encoding.
+constexpr std::array kKnownAliases{
+    KnownAlias{"utf8", 0},
+    KnownAlias{"big5", 1}, KnownAlias{"windows950", 1}, KnownAlias{"xbig5", 1}, KnownAlias{"csbig5", 1},
+    KnownAlias{"cp950", 2}, KnownAlias{"ibm950", 2},
+    KnownAlias{"big5hkscs", 3},
+    KnownAlias{"shiftjis", 4}, KnownAlias{"sjis", 4}, KnownAlias{"cp932", 4}, KnownAlias{"windows31j", 4},
+    KnownAlias{"mskanji", 4},
+    KnownAlias{"eucjp", 5},
+    KnownAlias{"euckr", 6},
+    KnownAlias{"gbk", 7}, KnownAlias{"cp936", 7}, KnownAlias{"windows936", 7},
+    KnownAlias{"gb2312", 8},
+    KnownAlias{"gb18030", 9},
+    KnownAlias{"iso88591", 10}, KnownAlias{"latin1", 10},
+    KnownAlias{"usascii", 11}, KnownAlias{"ascii", 11},
+    KnownAlias{"windows1252", 12}, KnownAlias{"cp1252", 12},
+    KnownAlias{"utf16", 13},
+    KnownAlias{"utf16le", 14},
+    KnownAlias{"utf16be", 15},
+};
 
-std::string convert_encoding(const std::string_view input,
-                             const std::string_view from_encoding,
-                             const std::string_view to_encoding) {
-    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, to_encoding);
-}
+constexpr std::size_t kKnownAliasTableSize = 128;
+constexpr std::size_t kMaxKnownAliasLength = 16;
 
-std::string to_utf8(const std::string_view input, const std::string_view from_encoding) {
-    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, "UTF-8");
+// Seeded FNV-1a with a final avalanche (FNV's low bits alone spread poorly); the seed is
+// chosen at compile time so that all known aliases land in distinct buckets.
+constexpr std::uint32_t known_alias_hash(const std::string_view folded, const std::uint32_t seed) {
+    std::uint32_t h = 2166136261u ^ seed;
+    for (const char c : folded) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
 }
 
-std::string from_utf8(const std::string_view utf8, const std::string_view to_encoding) {
-    return convert_encoding_impl(utf8.data(), safe_size_to_int32(utf8.size()), "UTF-8", to_encoding);
+consteval std::uint32_t find_known_alias_seed() {
+    for (std::uint32_t seed = 0; seed < 10000; ++seed) {
+        std::array<bool, kKnownAliasTableSize> used{};
+        bool collision = false;
+        for (const auto& alias : kKnownAliases) {
+            const auto bucket = known_alias_hash(alias.folded, seed) % kKnownAliasTableSize;
+            if (used[bucket]) {
+                collision = true;
+                break;
+            }
+            used[bucket] = true;
+        }
+        if (!collision) return seed;
+    }
+    throw "no perfect hash seed for kKnownAliases";
 }
 
-std::string big5_to_utf8(const std::string_view big5_bytes) {
-    return to_utf8(big5_bytes, "Big5");
-}
+constexpr std::uint32_t kKnownAliasSeed = find_known_alias_seed();
 
-std::string utf8_to_big5(const std::string_view utf8) {
-    return from_utf8(utf8, "Big5");
+consteval std::array<std::int8_t, kKnownAliasTableSize> build_known_alias_table() {
+    std::array<std::int8_t, kKnownAliasTableSize> table{};
+    for (auto& bucket : table) bucket = -1;
+    for (std::size_t i = 0; i < kKnownAliases.size(); ++i) {
+        if (kKnownAliases[i].folded.size() > kMaxKnownAliasLength) throw "known alias too long";
+        table[known_alias_hash(kKnownAliases[i].folded, kKnownAliasSeed) % kKnownAliasTableSize] =
+            static_cast<std::int8_t>(i);
+    }
+    return table;
 }
 
-std::string big5_to_utf8_dr(const std::string_view big5_bytes) {
-    // Big5 bytes (1–2 per char) can expand up to ~3 bytes/char in UTF-8
-    const std::size_t guess = safe_add(safe_multiply(big5_bytes.size(), 3u), 16u);
-    return convert_encoding_streaming(big5_bytes, "Big5", "UTF-8", guess);
+constexpr auto kKnownAliasTable = build_known_alias_table();
+
+// Returns the slot for a known alias, or -1.
+constexpr int find_known_encoding_slot(const std::string_view name) {
+    char buf[kMaxKnownAliasLength]{};
+    const int n = fold_encoding_name(name, buf, sizeof(buf));
+    if (n <= 0) return -1;
+    const std::string_view folded(buf, static_cast<std::size_t>(n));
+    const int index = kKnownAliasTable[known_alias_hash(folded, kKnownAliasSeed) % kKnownAliasTableSize];
+    if (index < 0 || kKnownAliases[static_cast<std::size_t>(index)].folded != folded) return -1;
+    return kKnownAliases[static_cast<std::size_t>(index)].slot;
 }
 
-std::string utf8_to_big5_dr(const std::string_view utf8) {
-    // UTF-8 (1–4 bytes/char) maps to Big5 (1–2 bytes/char); allocate generously
-    const std::size_t guess = safe_add(safe_multiply(utf8.size(), 2u), 16u);
-    return convert_encoding_streaming(utf8, "UTF-8", "Big5", guess);
+static_assert(find_known_encoding_slot("Big5") == 1);
+static_assert(find_known_encoding_slot("UTF-8") == 0);
+static_assert(find_known_encoding_slot("Shift_JIS") == 4);
+static_assert(find_known_encoding_slot("Big5-HKSCS") == 3);
+static_assert(find_known_encoding_slot("UTF-8,swaplfnl") == -1);
+static_assert(find_known_encoding_slot("KOI8-R") == -1);
+
+/**
+ * Resolve an encoding name: known aliases come from their preresolved slot,
+ * everything else from the memoizing registry.
+ * Throws std::runtime_error if ICU does not know the encoding.
+ */
+const detail::EncodingRecord& resolve_encoding(const std::string_view name) {
+    static std::array<std::atomic<const detail::EncodingRecord*>, kKnownEncodings.size()> slots{};
+    const int slot = find_known_encoding_slot(name);
+    if (slot < 0) {
+        return EncodingRegistry::instance().resolve(name);
+    }
+    auto& cached = slots[static_cast<std::size_t>(slot)];
+    const detail::EncodingRecord* rec = cached.load(std::memory_order_acquire);
+    if (rec == nullptr) {
+        rec = &EncodingRegistry::instance().resolve(kKnownEncodings[static_cast<std::size_t>(slot)]);
+        cached.store(rec, std::memory_order_release);
+    }
+    return *rec;
 }
 
-std::string convert_encoding(const char* input,
-                             const std::string_view from_encoding,
-                             const std::string_view to_encoding) {
-    return convert_encoding_impl(input, -1, from_encoding, to_encoding);
+/**
+ * Clone the encoding's prototype converter with ucnv_safeClone.
+ * When `buffer` is large enough ICU places the clone there (caller-provided or pooled memory);
+ * otherwise, or when `buffer` is null, ICU allocates it. Either way the result must be released
+ * with ucnv_close, which does not free caller memory.
+ * Cloning skips alias lookup, shared-data loading and callback setup; callbacks are copied.
+ */
+UConverter* clone_converter(const Encoding& encoding, void* buffer, int32_t buffer_size) {
+    UErrorCode status = U_ZERO_ERROR;
+    // ucnv_clone (ICU 71+) always allocates; only the deprecated ucnv_safeClone honours a buffer.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#elif defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4996)
+#endif
+    UConverter* conv = ucnv_safeClone(encoding.record().prototype, buffer,
+                                      buffer != nullptr ? &buffer_size : nullptr, &status);
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+    if (U_FAILURE(status) || conv == nullptr) {
+        throw std::runtime_error("Failed to clone ICU converter: " + std::string(encoding.name()));
+    }
+    return conv;
 }
 
-std::string to_utf8(const char* input, const std::string_view from_encoding) {
-    return convert_encoding_impl(input, -1, from_encoding, "UTF-8");
+} // namespace
+
+/**
+ * Bounded pool of ready converters for one encoding.
+ *
+ * Idle converters sit in fixed arrays of atomic slots, one array per shard; a thread uses the
+ * shard of the CPU it runs on, so concurrent tasks rarely touch the same cache line. Checkout
+ * exchanges a slot with null (own shard first, then the others), return CASes into an empty
+ * slot of the own shard or closes the converter when the shard is full. No locks, no ABA:
+ * a slot only ever holds a pointer owned by the pool or null.
+ */
+class detail::ConverterPool {
+public:
+    ConverterPool(const Encoding& encoding, const ConverterPoolOptions& options)
+        : encoding_(encoding),
+          shard_count_(options.shards != 0 ? options.shards : std::max(1u, std::thread::hardware_concurrency())),
+          per_shard_(std::max<std::size_t>(1, options.per_shard_capacity)),
+          shards_(std::make_unique<Shard[]>(shard_count_)) {
+        for (std::size_t i = 0; i < shard_count_; ++i) {
+            shards_[i].slots = std::make_unique<std::atomic<UConverter*>[]>(per_shard_);
+        }
+    }
+
+    UConverter* acquire();
+    void release(UConverter* conv) noexcept;
+    // Fill every empty slot of every shard with a fresh converter.
+    void prefill();
+    [[nodiscard]] ConverterPoolStats stats() const noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<UConverter*>[]> slots;
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        std::atomic<std::uint64_t> discards{0};
+    };
+
+    [[nodiscard]] std::size_t current_shard() const noexcept;
+
+    Encoding encoding_;
+    std::size_t shard_count_;
+    std::size_t per_shard_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+namespace {
+
+std::atomic<ConverterCaching> g_converter_caching{ConverterCaching::clone};
+
+std::mutex g_pool_options_mutex;
+ConverterPoolOptions g_pool_options;
+
+detail::ConverterPool& pool_for(const Encoding& encoding) {
+    auto& slot = encoding.record().pool;
+    if (detail::ConverterPool* pool = slot.load(std::memory_order_acquire)) {
+        return *pool;
+    }
+    auto fresh = std::make_unique<detail::ConverterPool>(encoding, converter_pool_options());
+    detail::ConverterPool* expected = nullptr;
+    if (slot.compare_exchange_strong(expected, fresh.get(), std::memory_order_acq_rel)) {
+        return *fresh.release();
+    }
+    return *expected;
 }
 
-std::string from_utf8(const char* utf8, const std::string_view to_encoding) {
-    return convert_encoding_impl(utf8, -1, "UTF-8", to_encoding);
+/**
+ * RAII converter lease for one conversion.
+ * - clone mode: the encoding's prototype is cloned into inline storage, so an instance declared
+ *   on the stack costs no heap allocation for table-driven converters (SBCS/DBCS/MBCS, UTF-*);
+ *   converters that need more room (e.g. ISO-2022) transparently get a heap clone instead.
+ * - pooled mode: a ready converter is checked out of the encoding's pool and returned, reset,
+ *   in the destructor.
+ * Thread-safety: do not share a single instance across threads.
+ */
+class ConverterInstance {
+public:
+    explicit ConverterInstance(const Encoding& encoding) {
+        if (g_converter_caching.load(std::memory_order_relaxed) == ConverterCaching::pooled) {
+            pool_ = &pool_for(encoding);
+            conv_ = pool_->acquire();
+        } else {
+            conv_ = clone_converter(encoding, storage_, sizeof(storage_));
+        }
+    }
+    ~ConverterInstance() {
+        if (pool_) {
+            pool_->release(conv_);
+        } else {
+            ucnv_close(conv_);
+        }
+    }
+
+    ConverterInstance(const ConverterInstance&) = delete;
+    ConverterInstance& operator=(const ConverterInstance&) = delete;
+    ConverterInstance(ConverterInstance&&) = delete;
+    ConverterInstance& operator=(ConverterInstance&&) = delete;
+
+    [[nodiscard]] UConverter* get() const { return conv_; }
+
+private:
+    alignas(std::max_align_t) std::byte storage_[U_CNV_SAFECLONE_BUFFERSIZE];
+    detail::ConverterPool* pool_{nullptr};
+    UConverter* conv_{nullptr};
+};
+
+/**
+ * Page in a table-driven converter's mapping data by converting every round-trip code point
+ * to bytes and back. Best effort: conversion errors are ignored. Unicode encodings are
+ * algorithmic and have no tables to touch.
+ */
+void touch_conversion_tables(const Encoding& encoding) {
+    if (encoding.has(EncodingFlags::unicode)) return;
+    // A private clone, so warming up never counts against (or drains) the converter pool.
+    alignas(std::max_align_t) std::byte storage[U_CNV_SAFECLONE_BUFFERSIZE];
+    const std::unique_ptr<UConverter, decltype(&ucnv_close)> conv(
+        clone_converter(encoding, storage, sizeof(storage)), &ucnv_close);
+    UErrorCode status = U_ZERO_ERROR;
+    const std::unique_ptr<USet, decltype(&uset_close)> set(uset_openEmpty(), &uset_close);
+    ucnv_getUnicodeSet(conv.get(), set.get(), UCNV_ROUNDTRIP_SET, &status);
+    if (U_FAILURE(status)) return;
+
+    UChar units[1024];
+    UChar back[1024];
+    std::vector<char> bytes(std::size(units) * static_cast<std::size_t>(encoding.max_char_size()) + 16);
+    int32_t n = 0;
+    const auto round_trip = [&] {
+        UErrorCode s2 = U_ZERO_ERROR;
+        const int32_t len = ucnv_fromUChars(conv.get(), bytes.data(), static_cast<int32_t>(bytes.size()), units, n, &s2);
+        if (U_SUCCESS(s2)) {
+            ucnv_toUChars(conv.get(), back, std::size(back), bytes.data(), len, &s2);
+        }
+        n = 0;
+    };
+    const int32_t ranges = uset_getRangeCount(set.get());
+    for (int32_t i = 0; i < ranges; ++i) {
+        UChar32 start = 0;
+        UChar32 end = 0;
+        UErrorCode s2 = U_ZERO_ERROR;
+        uset_getItem(set.get(), i, &start, &end, nullptr, 0, &s2);
+        if (U_FAILURE(s2)) continue;
+        for (UChar32 cp = start; cp <= end; ++cp) {
+            if (n + 2 > static_cast<int32_t>(std::size(units))) round_trip();
+            U16_APPEND_UNSAFE(units, n, cp);
+        }
+    }
+    if (n > 0) round_trip();
 }
 
-std::string convert_encoding(const char* input, const std::size_t length,
-                             const std::string_view from_encoding,
-                             const std::string_view to_encoding) {
-    return convert_encoding_impl(input, safe_size_to_int32(length), from_encoding, to_encoding);
+void preload_encoding(const Encoding& encoding) {
+    touch_conversion_tables(encoding);
+    if (g_converter_caching.load(std::memory_order_relaxed) == ConverterCaching::pooled) {
+        pool_for(encoding).prefill();
+    }
 }
 
-std::string to_utf8(const char* input, const std::size_t length, const std::string_view from_encoding) {
-    return convert_encoding_impl(input, safe_size_to_int32(length), from_encoding, "UTF-8");
+// Converter source for either kind of encoding argument.
+Encoding resolve_spec(const std::string_view name) { return Encoding(name); }
+const Encoding& resolve_spec(const Encoding& encoding) { return encoding; }
+
+// Output string for a given allocator: std::string or std::pmr::string.
+template <typename Alloc>
+using BasicOutString = std::basic_string<char, std::char_traits<char>, Alloc>;
+
+// -----------------------------------------------------------------------------
+// Memory budget
+// -----------------------------------------------------------------------------
+
+std::atomic<std::size_t> g_memory_budget{kUnlimitedMemoryBudget};
+// Thread override set by ScopedMemoryBudget; kNoBudgetOverride defers to the global budget.
+constexpr std::size_t kNoBudgetOverride = std::numeric_limits<std::size_t>::max();
+thread_local std::size_t t_memory_budget = kNoBudgetOverride;
+
+std::size_t effective_memory_budget() noexcept {
+    return t_memory_budget != kNoBudgetOverride ? t_memory_budget : g_memory_budget.load(std::memory_order_relaxed);
 }
 
-std::string from_utf8(const char* utf8, const std::size_t length, const std::string_view to_encoding) {
-    return convert_encoding_impl(utf8, safe_size_to_int32(length), "UTF-8", to_encoding);
+// Memory held by one conversion, checked against the budget in force when it started.
+class BudgetTracker {
+public:
+    BudgetTracker() noexcept : budget_(effective_memory_budget()) {}
+
+    [[nodiscard]] bool limited() const noexcept { return budget_ != kUnlimitedMemoryBudget; }
+
+    // Bytes that may still be charged.
+    [[nodiscard]] std::size_t remaining() const noexcept {
+        return limited() ? budget_ - used_ : std::numeric_limits<std::size_t>::max();
+    }
+
+    // Throws MemoryBudgetExceeded if holding `bytes` more would exceed the budget.
+    void charge(const std::size_t bytes) {
+        if (bytes > remaining()) {
+            throw MemoryBudgetExceeded(used_ > std::numeric_limits<std::size_t>::max() - bytes
+                                           ? std::numeric_limits<std::size_t>::max() : used_ + bytes,
+                                       budget_);
+        }
+        used_ += bytes;
+    }
+
+    void release(const std::size_t bytes) noexcept { used_ -= std::min(bytes, used_); }
+
+    // Capacity for a buffer that will be charged: `wanted` clamped to what is left, but never
+    // below `minimum` (charging that then reports the overrun).
+    [[nodiscard]] std::size_t fit(const std::size_t wanted, const std::size_t minimum = 0) const noexcept {
+        return std::max(std::min(wanted, remaining()), minimum);
+    }
+
+private:
+    std::size_t budget_;
+    std::size_t used_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Huge pages
+// -----------------------------------------------------------------------------
+
+constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+std::atomic<bool> g_huge_pages_enabled{HugePageOptions{}.enabled};
+std::atomic<std::size_t> g_huge_page_threshold{HugePageOptions{}.threshold_bytes};
+
+bool wants_huge_pages(const std::size_t bytes) noexcept {
+    return g_huge_pages_enabled.load(std::memory_order_relaxed)
+           && bytes >= g_huge_page_threshold.load(std::memory_order_relaxed);
 }
 
-// Big5 helpers (C-style, null-terminated)
-std::string big5_to_utf8(const char* big5_bytes) {
-    return to_utf8(big5_bytes, "Big5");
+constexpr std::size_t round_up_to_huge_page(const std::size_t bytes) noexcept {
+    return (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
 }
 
-std::string utf8_to_big5(const char* utf8) {
-    return from_utf8(utf8, "Big5");
+// Ask for huge pages on the 2 MiB-aligned part of [data, data + bytes). Only pages not yet
+// touched benefit, so call it before writing to fresh memory.
+void advise_huge_pages([[maybe_unused]] char* const data, [[maybe_unused]] const std::size_t bytes) noexcept {
+#if defined(MADV_HUGEPAGE)
+    const auto address = reinterpret_cast<std::uintptr_t>(data);
+    const std::uintptr_t begin = (address + kHugePageSize - 1) & ~std::uintptr_t{kHugePageSize - 1};
+    const std::uintptr_t end = (address + bytes) & ~std::uintptr_t{kHugePageSize - 1};
+    if (end > begin) madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+#endif
 }
 
-std::string big5_to_utf8_dr(const char* big5_bytes) {
-    if (big5_bytes == nullptr) {
-        throw std::invalid_argument("big5_to_utf8_dr: input is null");
+// Resize an output string; large std::string buffers are reserved and advised before the
+// resize first touches them. Caller-provided pmr resources are left alone.
+template <typename Alloc>
+void resize_output(BasicOutString<Alloc>& out, const std::size_t size) {
+    if constexpr (std::is_same_v<Alloc, std::allocator<char>>) {
+        if (size > out.capacity() && wants_huge_pages(size)) {
+            out.reserve(size);
+            advise_huge_pages(out.data() + out.size(), out.capacity() - out.size());
+        }
     }
-    const std::size_t len = std::char_traits<char>::length(big5_bytes);
-    const std::size_t guess = safe_add(safe_multiply(len, 3u), 16u);
-    return convert_encoding_streaming(std::string_view(big5_bytes, len), "Big5", "UTF-8", guess);
+    out.resize(size);
 }
 
-std::string utf8_to_big5_dr(const char* utf8) {
-    if (utf8 == nullptr) {
-        throw std::invalid_argument("utf8_to_big5_dr: input is null");
+class HugePageResource final : public std::pmr::memory_resource {
+private:
+    void* do_allocate(const std::size_t bytes, const std::size_t alignment) override {
+#if defined(MADV_HUGEPAGE)
+        if (bytes >= kHugePageSize && alignment <= kHugePageSize) {
+            const std::size_t length = round_up_to_huge_page(bytes);
+            // Over-map by one huge page, then trim to a 2 MiB-aligned range.
+            void* const raw = mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED) throw std::bad_alloc();
+            char* const first = static_cast<char*>(raw);
+            char* const begin = first + (kHugePageSize - reinterpret_cast<std::uintptr_t>(first) % kHugePageSize)
+                                            % kHugePageSize;
+            if (begin != first) munmap(first, static_cast<std::size_t>(begin - first));
+            char* const end = begin + length;
+            if (const std::size_t tail = static_cast<std::size_t>(first + length + kHugePageSize - end); tail != 0) {
+                munmap(end, tail);
+            }
+            madvise(begin, length, MADV_HUGEPAGE);
+            return begin;
+        }
+#endif
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
     }
-    const std::size_t len = std::char_traits<char>::length(utf8);
-    const std::size_t guess = safe_add(safe_multiply(len, 2u), 16u);
-    return convert_encoding_streaming(std::string_view(utf8, len), "UTF-8", "Big5", guess);
-}
 
-// Big5 helpers (C-style with explicit length)
-std::string big5_to_utf8(const char* big5_bytes, const std::size_t length) {
-    return to_utf8(big5_bytes, length, "Big5");
-}
+    void do_deallocate(void* const p, const std::size_t bytes, const std::size_t alignment) override {
+#if defined(MADV_HUGEPAGE)
+        if (bytes >= kHugePageSize && alignment <= kHugePageSize) {
+            munmap(p, round_up_to_huge_page(bytes));
+            return;
+        }
+#endif
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
 
-std::string utf8_to_big5(const char* utf8, const std::size_t length) {
-    return from_utf8(utf8, length, "Big5");
-}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
 
-std::string big5_to_utf8_dr(const char* big5_bytes, const std::size_t length) {
-    if (big5_bytes == nullptr) {
-        if (length == 0) return {};
-        throw std::invalid_argument("big5_to_utf8_dr: input is null");
+// -----------------------------------------------------------------------------
+// Per-thread UTF-16 scratch buffers
+// -----------------------------------------------------------------------------
+
+std::atomic<std::size_t> g_scratch_max_retained_bytes{ScratchBufferOptions{}.max_retained_bytes};
+std::atomic<std::uint32_t> g_scratch_trim_after_calls{ScratchBufferOptions{}.trim_after_calls};
+std::atomic<std::size_t> g_scratch_total_bytes{0};
+std::atomic<std::size_t> g_scratch_threads{0};
+std::atomic<std::uint64_t> g_scratch_reuses{0};
+std::atomic<std::uint64_t> g_scratch_allocations{0};
+
+/**
+ * High-water UTF-16 buffer owned by one thread. Uninitialized storage, so reuse costs
+ * neither zero-filling nor page faults once warmed.
+ */
+class ThreadScratch {
+public:
+    ThreadScratch() = default;
+    ThreadScratch(const ThreadScratch&) = delete;
+    ThreadScratch& operator=(const ThreadScratch&) = delete;
+    ~ThreadScratch() { reset(); }
+
+    [[nodiscard]] bool in_use() const noexcept { return in_use_; }
+    [[nodiscard]] std::size_t bytes() const noexcept { return capacity_ * sizeof(UChar); }
+
+    UChar* acquire(const std::size_t units) {
+        if (units > capacity_) {
+            reset();
+            buf_ = std::make_unique_for_overwrite<UChar[]>(units);
+            set_capacity(units);
+            g_scratch_allocations.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            g_scratch_reuses.fetch_add(1, std::memory_order_relaxed);
+        }
+        in_use_ = true;
+        return buf_.get();
+    }
+
+    // Applies the trim policy after a conversion that needed `units`.
+    void release(const std::size_t units) noexcept {
+        in_use_ = false;
+        const std::uint32_t trim_after = g_scratch_trim_after_calls.load(std::memory_order_relaxed);
+        if (trim_after == 0 || units > capacity_ / 4) {
+            small_calls_ = 0;
+            largest_recent_ = 0;
+            return;
+        }
+        largest_recent_ = std::max(largest_recent_, units);
+        if (++small_calls_ >= trim_after) {
+            const std::size_t keep = largest_recent_;
+            reset();
+            if (keep > 0) {
+                // Shrinking is best effort; keep nothing if the smaller buffer cannot be had.
+                try {
+                    buf_ = std::make_unique_for_overwrite<UChar[]>(keep);
+                    set_capacity(keep);
+                } catch (const std::bad_alloc&) {
+                }
+            }
+        }
+    }
+
+    void reset() noexcept {
+        buf_.reset();
+        set_capacity(0);
+        small_calls_ = 0;
+        largest_recent_ = 0;
+    }
+
+private:
+    void set_capacity(const std::size_t units) noexcept {
+        if (capacity_ == 0 && units != 0) g_scratch_threads.fetch_add(1, std::memory_order_relaxed);
+        if (capacity_ != 0 && units == 0) g_scratch_threads.fetch_sub(1, std::memory_order_relaxed);
+        g_scratch_total_bytes.fetch_add(units * sizeof(UChar), std::memory_order_relaxed);
+        g_scratch_total_bytes.fetch_sub(capacity_ * sizeof(UChar), std::memory_order_relaxed);
+        capacity_ = units;
     }
-    const std::size_t guess = safe_add(safe_multiply(length, 3u), 16u);
-    return convert_encoding_streaming(std::string_view(big5_bytes, length), "Big5", "UTF-8", guess);
+
+    std::unique_ptr<UChar[]> buf_;
+    std::size_t capacity_{0};
+    std::size_t largest_recent_{0};
+    std::uint32_t small_calls_{0};
+    bool in_use_{false};
+};
+
+ThreadScratch& thread_scratch() {
+    thread_local ThreadScratch scratch;
+    return scratch;
 }
 
-std::string utf8_to_big5_dr(const char* utf8, const std::size_t length) {
-    if (utf8 == nullptr) {
-        if (length == 0) return {};
-        throw std::invalid_argument("utf8_to_big5_dr: input is null");
+/**
+ * UTF-16 scratch for one two-pass conversion.
+ * - std::allocator output: the calling thread's retained buffer, unless the request exceeds the
+ *   retention cap or the buffer is already in use further up the stack; then a one-off buffer.
+ * - polymorphic allocator output: always allocated from the caller's memory resource.
+ */
+class Utf16Scratch {
+public:
+    Utf16Scratch(const std::size_t units, const std::allocator<char>&)
+        : units_(units),
+          owned_(wants_huge_pages(units * sizeof(UChar)) ? huge_page_resource() : std::pmr::new_delete_resource()) {
+        ThreadScratch& scratch = thread_scratch();
+        if (!scratch.in_use()
+            && units <= g_scratch_max_retained_bytes.load(std::memory_order_relaxed) / sizeof(UChar)) {
+            thread_ = &scratch;
+            data_ = scratch.acquire(units);
+        } else {
+            g_scratch_allocations.fetch_add(1, std::memory_order_relaxed);
+            owned_.resize(units);
+            data_ = owned_.data();
+        }
+    }
+    Utf16Scratch(const std::size_t units, const std::pmr::polymorphic_allocator<char>& alloc)
+        : units_(units), owned_(units, alloc.resource()), data_(owned_.data()) {}
+    ~Utf16Scratch() {
+        if (thread_) thread_->release(units_);
     }
-    const std::size_t guess = safe_add(safe_multiply(length, 2u), 16u);
-    return convert_encoding_streaming(std::string_view(utf8, length), "UTF-8", "Big5", guess);
+
+    Utf16Scratch(const Utf16Scratch&) = delete;
+    Utf16Scratch& operator=(const Utf16Scratch&) = delete;
+
+    [[nodiscard]] UChar* data() const noexcept { return data_; }
+
+private:
+    std::size_t units_;
+    ThreadScratch* thread_{nullptr};
+    std::pmr::vector<UChar> owned_;
+    UChar* data_{nullptr};
+};
+
+// -----------------------------------------------------------------------------
+// Output size estimation
+// -----------------------------------------------------------------------------
+
+struct ByteCounts {
+    std::size_t high = 0;              // bytes >= 0x80
+    std::size_t continuation = 0;      // bytes 0x80-0xBF (UTF-8 continuation bytes)
+    std::size_t high_before_ascii = 0; // bytes >= 0x80 followed by a byte < 0x80
+};
+
+// Sum of the eight byte lanes of `lanes` (each lane at most 255).
+constexpr std::size_t sum_byte_lanes(const std::uint64_t lanes) noexcept {
+    const std::uint64_t pairs = (lanes & 0x00FF00FF00FF00FFull) + ((lanes >> 8) & 0x00FF00FF00FF00FFull);
+    return static_cast<std::size_t>((pairs * 0x0001000100010001ull) >> 48);
+}
+
+/**
+ * Count byte classes eight bytes at a time (SWAR on 64-bit words, no intrinsics or popcount
+ * needed): each class test leaves a 0/1 in every byte lane, lanes are summed into per-lane
+ * counters and folded every 255 words before they can overflow.
+ */
+ByteCounts count_bytes(const std::string_view input) noexcept {
+    constexpr std::uint64_t kOnes = 0x0101010101010101ull;
+    ByteCounts counts;
+    const char* const data = input.data();
+    const std::size_t size = input.size();
+    std::size_t i = 0;
+    while (i + 9 <= size) {
+        std::uint64_t high = 0;
+        std::uint64_t continuation = 0;
+        std::uint64_t high_before_ascii = 0;
+        for (int words = 0; words < 255 && i + 9 <= size; ++words, i += 8) {
+            std::uint64_t word;
+            std::uint64_t next; // the same bytes shifted by one, for the "followed by" test
+            std::memcpy(&word, data + i, sizeof(word));
+            std::memcpy(&next, data + i + 1, sizeof(next));
+            high += (word >> 7) & kOnes;
+            // bit 7 set and bit 6 clear; shifting left moves each byte's bit 6 onto its own bit 7
+            continuation += ((word & ~(word << 1)) >> 7) & kOnes;
+            high_before_ascii += ((word & ~next) >> 7) & kOnes;
+        }
+        counts.high += sum_byte_lanes(high);
+        counts.continuation += sum_byte_lanes(continuation);
+        counts.high_before_ascii += sum_byte_lanes(high_before_ascii);
+    }
+    for (; i < size; ++i) {
+        const auto byte = static_cast<unsigned char>(data[i]);
+        if (byte < 0x80) continue;
+        ++counts.high;
+        if (byte < 0xC0) ++counts.continuation;
+        if (i + 1 < size && static_cast<unsigned char>(data[i + 1]) < 0x80) ++counts.high_before_ascii;
+    }
+    return counts;
+}
+
+/**
+ * Predict the output size from the input's byte classes; an upper bound for well-formed input
+ * in the common cases, within a few percent of the real size:
+ *  - UTF-8 source: every non-ASCII character has exactly one lead byte (high minus continuation
+ *    bytes) and becomes at most max_char_size bytes per UTF-16 unit; ASCII stays one byte.
+ *  - Big5 to UTF-8: each double-byte character has a high lead byte and a trail that is either
+ *    high (0xA1-0xFE) or ASCII-range (0x40-0x7E). A low trail always follows its high lead, so
+ *    characters ~ (high bytes + high bytes followed by ASCII) / 2 (over-counting only at the end
+ *    of CJK runs), and each adds one byte (2 -> 3).
+ * Other pairs fall back to input size times the target's maximum bytes per UTF-16 unit.
+ *
+ * The same counts give a proven lower bound for well-formed input: every character of a UTF-8
+ * source becomes at least one byte, and Big5 to UTF-8 never shrinks (ASCII stays one byte, a
+ * double-byte character becomes at least two). Other pairs have no known minimum (0).
+ */
+struct OutputBounds {
+    std::size_t minimum;
+    std::size_t estimate;
+};
+
+OutputBounds output_bounds(const std::string_view input, const Encoding& from, const Encoding& to) noexcept {
+    const std::size_t size = input.size();
+    const auto max_char_size = static_cast<std::size_t>(to.max_char_size());
+    const std::size_t fallback = size > (std::numeric_limits<std::size_t>::max() - 16) / max_char_size
+                                     ? std::numeric_limits<std::size_t>::max()
+                                     : size * max_char_size + 16;
+    if (from.has(EncodingFlags::utf8)) {
+        if (to.has(EncodingFlags::utf8)) return {size, size + 16};
+        const ByteCounts counts = count_bytes(input);
+        const std::size_t characters = counts.high - std::min(counts.continuation, counts.high);
+        const std::size_t minimum = (size - counts.high) + characters;
+        if (!to.has(EncodingFlags::ascii_compatible)) return {minimum, fallback};
+        return {minimum, std::min(fallback, (size - counts.high) + characters * max_char_size + 16)};
+    }
+    if (from == Encoding::big5() && to.has(EncodingFlags::utf8)) {
+        const ByteCounts counts = count_bytes(input);
+        return {size, size + (counts.high + counts.high_before_ascii + 1) / 2 + 16};
+    }
+    return {0, fallback};
+}
+
+std::size_t estimate_output(const std::string_view input, const Encoding& from, const Encoding& to) noexcept {
+    return output_bounds(input, from, to).estimate;
+}
+
+// Fails fast with MemoryBudgetExceeded, before anything is allocated or converted, when even
+// the smallest possible output does not fit the budget in force.
+void require_budget_for(const std::size_t minimum_output) {
+    const std::size_t budget = effective_memory_budget();
+    if (budget != kUnlimitedMemoryBudget && minimum_output > budget) {
+        throw MemoryBudgetExceeded(minimum_output, budget);
+    }
+}
+
+// Output capacity estimate for a budgeted conversion, after require_budget_for() its minimum.
+std::size_t budgeted_estimate(const std::string_view input, const Encoding& from, const Encoding& to) {
+    const OutputBounds bounds = output_bounds(input, from, to);
+    require_budget_for(bounds.minimum);
+    return bounds.estimate;
+}
+
+// -----------------------------------------------------------------------------
+// Small-input fast path
+// -----------------------------------------------------------------------------
+
+// Inputs up to this many bytes are converted entirely through stack buffers.
+constexpr std::size_t kSmallInputBytes = 256;
+// Room for 4 output bytes per input byte; anything larger falls back to the regular path.
+constexpr std::size_t kSmallOutputBytes = 4 * kSmallInputBytes;
+
+/**
+ * Convert a small input in a single ucnv_convertEx call through a stack pivot and stack output
+ * buffer, then build the result once with its exact size (fitting SSO for short results).
+ * Returns false without touching `out` if the conversion fails or the output does not fit;
+ * the caller then runs its regular path, which resets the converters and reports real errors.
+ * The result is charged to the memory budget like any other output (the stack buffers are not);
+ * throws MemoryBudgetExceeded if it does not fit.
+ */
+template <typename Alloc>
+bool try_convert_small(UConverter* from, UConverter* to, const char* input, const std::size_t length,
+                       BasicOutString<Alloc>& out) {
+    UChar pivot[kSmallInputBytes];
+    UChar* pivotSource = pivot;
+    UChar* pivotTarget = pivot;
+    char buf[kSmallOutputBytes];
+    char* target = buf;
+    const char* source = input;
+    UErrorCode status = U_ZERO_ERROR;
+    ucnv_convertEx(to, from, &target, buf + sizeof(buf), &source, input + length,
+                   pivot, &pivotSource, &pivotTarget, pivot + std::size(pivot),
+                   /*reset*/ 1, /*flush*/ 1, &status);
+    if (U_FAILURE(status)) {
+        return false;
+    }
+    const auto written = static_cast<std::size_t>(target - buf);
+    BudgetTracker budget;
+    budget.charge(written);
+    out.assign(buf, written);
+    return true;
+}
+
+/**
+ * Core conversion implementation using ICU in two pass preflight+convert steps:
+ * 1) Source bytes -> UTF-16 (UChar) via ucnv_toUChars (preflight to size, then actual convert).
+ * 2) UTF-16 -> target bytes via ucnv_fromUChars (preflight to size, then actual convert).
+ *
+ * Parameters:
+ * - input: pointer to the source byte sequence; must not be null.
+ * - length: number of bytes in input. Use -1 to indicate NUL-terminated input (ICU convention).
+ * - from_encoding: ICU canonical or alias name, or resolved Encoding, of the source encoding.
+ * - to_encoding: ICU canonical or alias name, or resolved Encoding, of the destination encoding.
+ *
+ * - alloc: allocator of the returned string; for polymorphic allocators the UTF-16 scratch
+ *   buffer comes from the same memory resource, otherwise from the thread's retained buffer.
+ *
+ * Throws std::invalid_argument if input is null.
+ * Throws std::runtime_error on ICU errors during either phase.
+ * Returns the converted bytes without a terminating NUL.
+ */
+template <typename Alloc, typename EncodingSpec>
+BasicOutString<Alloc> convert_encoding_impl(const char* input,
+                                            const int32_t length,
+                                            const EncodingSpec& from_encoding,
+                                            const EncodingSpec& to_encoding,
+                                            const Alloc& alloc) {
+    if (input == nullptr) {
+        if (length == 0) {
+            return BasicOutString<Alloc>(alloc);
+        }
+        throw std::invalid_argument("convert_encoding: input is null");
+    }
+
+    const ConverterInstance from(resolve_spec(from_encoding));
+    const ConverterInstance to(resolve_spec(to_encoding));
+
+    const std::size_t known_length = length >= 0 ? static_cast<std::size_t>(length)
+                                                 : std::char_traits<char>::length(input);
+    if (known_length <= kSmallInputBytes) {
+        BasicOutString<Alloc> small(alloc);
+        if (try_convert_small(from.get(), to.get(), input, known_length, small)) {
+            return small;
+        }
+    }
+
+    // Step 1: Convert from source bytes to UTF-16 (UChar)
+    UErrorCode status = U_ZERO_ERROR;
+    const int32_t uLen = ucnv_toUChars(from.get(), nullptr, 0, input, length, &status);
+    if (status != U_BUFFER_OVERFLOW_ERROR && U_FAILURE(status)) {
+        throw std::runtime_error("ICU preflight toUChars failed for encoding: " + std::string(encoding_label(from_encoding)));
+    }
+    status = U_ZERO_ERROR;
+    BudgetTracker budget;
+    budget.charge(safe_multiply(static_cast<size_t>(uLen) + 1u, sizeof(UChar)));
+    const Utf16Scratch ubuf(static_cast<size_t>(uLen) + 1u, alloc);
+    const int32_t uWritten = ucnv_toUChars(from.get(), ubuf.data(), uLen + 1, input, length, &status);
+    if (U_FAILURE(status)) {
+        throw std::runtime_error("ICU toUChars failed for encoding: " + std::string(encoding_label(from_encoding)));
+    }
+
+    // Step 2: Convert from UTF-16 (UChar) to target bytes
+    status = U_ZERO_ERROR;
+    const int32_t outLen = ucnv_fromUChars(to.get(), nullptr, 0, ubuf.data(), uWritten, &status);
+    if (status != U_BUFFER_OVERFLOW_ERROR && U_FAILURE(status)) {
+        throw std::runtime_error("ICU preflight fromUChars failed for encoding: " + std::string(encoding_label(to_encoding)));
+    }
+    status = U_ZERO_ERROR;
+    budget.charge(static_cast<size_t>(outLen));
+    BasicOutString<Alloc> out(alloc);
+    resize_output(out, static_cast<size_t>(outLen));
+    const int32_t written = ucnv_fromUChars(to.get(), out.data(), outLen, ubuf.data(), uWritten, &status);
+    if (U_FAILURE(status)) {
+        throw std::runtime_error("ICU fromUChars failed for encoding: " + std::string(encoding_label(to_encoding)));
+    }
+    // No need to resize; ICU wrote exactly 'written' bytes, which should equal outLen
+    // but to be safe, adjust when different
+    if (written >= 0 && written < outLen) {
+        out.resize(static_cast<size_t>(written));
+    }
+
+    return out;
+}
+
+template <typename EncodingSpec>
+std::string convert_encoding_impl(const char* input,
+                                  const int32_t length,
+                                  const EncodingSpec& from_encoding,
+                                  const EncodingSpec& to_encoding) {
+    return convert_encoding_impl(input, length, from_encoding, to_encoding, std::allocator<char>());
+}
+
+// Pivot sizing for the streaming engine. Each ucnv_convertEx round trip moves at most one pivot
+// of UTF-16 units, so small pivots pay ICU's per-call overhead often; large ones fall out of L1.
+constexpr std::size_t kMinPivotUnits = 64;
+constexpr std::size_t kMaxPivotUnits = std::size_t{1} << 16;
+constexpr std::size_t kStackPivotUnits = 1024;
+
+std::atomic<std::size_t> g_pivot_units{StreamingOptions{}.pivot_units};
+
+std::size_t pivot_units_for(const std::size_t input_bytes) noexcept {
+    if (const std::size_t fixed = g_pivot_units.load(std::memory_order_relaxed); fixed != 0) {
+        return std::clamp(fixed, kMinPivotUnits, kMaxPivotUnits);
+    }
+    // Auto: roughly one pivot per input up to the stack buffer, then a larger heap pivot.
+    if (input_bytes <= 256) return 256;
+    if (input_bytes <= (std::size_t{64} << 10)) return kStackPivotUnits;
+    return std::size_t{4096};
+}
+
+// Streaming engine: drives ucnv_convertEx over the whole input through a small UTF-16 pivot.
+// The Output policy owns the target memory:
+//   void start(char*& target, const char*& targetLimit);    first window
+//   void overflow(char*& target, const char*& targetLimit); window is full: grow or drain it
+//   void finish(char* target);                               conversion complete
+//   BudgetTracker* budget();                                 tracker for the conversion, or null
+//                                                            when its memory is not limited
+template <typename Output, typename EncodingSpec>
+void run_streaming(UConverter* const from,
+                   UConverter* const to,
+                   const std::span<const std::span<const char>> fragments,
+                   Output& output,
+                   const EncodingSpec& from_encoding,
+                   const EncodingSpec& to_encoding) {
+    std::size_t input_bytes = 0;
+    for (const auto& fragment : fragments) input_bytes += fragment.size();
+
+    // Pivot buffer for UTF-16 code units used internally by ICU. It (and the converter state)
+    // carries over fragment boundaries, so a character may be split between fragments.
+    // A heap pivot is charged before the output, which then fits into what is left.
+    const std::size_t pivot_units = pivot_units_for(input_bytes);
+    UChar stack_pivot[kStackPivotUnits];
+    std::unique_ptr<UChar[]> heap_pivot;
+    if (pivot_units > kStackPivotUnits) {
+        if (BudgetTracker* const budget = output.budget()) budget->charge(pivot_units * sizeof(UChar));
+        heap_pivot = std::make_unique_for_overwrite<UChar[]>(pivot_units);
+    }
+    UChar* const pivot = heap_pivot ? heap_pivot.get() : stack_pivot;
+    UChar* pivotSource = pivot;
+    UChar* pivotTarget = pivot;
+
+    char* target = nullptr;
+    const char* targetLimit = nullptr;
+    output.start(target, targetLimit);
+
+    bool reset = true;
+
+    const std::size_t count = std::max<std::size_t>(fragments.size(), 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::span<const char> fragment = fragments.empty() ? std::span<const char>() : fragments[i];
+        if (fragment.data() == nullptr && !fragment.empty()) {
+            throw std::invalid_argument("convert_encoding_streaming: input is null but size != 0");
+        }
+        const bool last = i + 1 == count;
+        // ICU rejects a null source pointer even for empty input.
+        static constexpr char kEmpty = '\0';
+        const char* source = fragment.empty() ? &kEmpty : fragment.data();
+        const char* const sourceLimit = source + fragment.size();
+
+        for (;;) {
+            UErrorCode status = U_ZERO_ERROR;
+            const UBool flush = (last && source == sourceLimit) ? 1 : 0;
+            ucnv_convertEx(
+                /*targetCnv*/ to,
+                /*sourceCnv*/ from,
+                /*target*/ &target,
+                /*targetLimit*/ targetLimit,
+                /*source*/ &source,
+                /*sourceLimit*/ sourceLimit,
+                /*pivotStart*/ pivot,
+                /*pivotSource*/ &pivotSource,
+                /*pivotTarget*/ &pivotTarget,
+                /*pivotLimit*/ pivot + pivot_units,
+                /*reset*/ reset ? 1 : 0,
+                /*flush*/ flush,
+                /*status*/ &status);
+            reset = false;
+
+            if (status == U_BUFFER_OVERFLOW_ERROR) {
+                output.overflow(target, targetLimit);
+                continue;
+            }
+            if (U_FAILURE(status)) {
+                throw std::runtime_error(
+                    std::string("ICU ucnv_convertEx failed for ") + std::string(encoding_label(from_encoding)) + " -> "
+                    + std::string(encoding_label(to_encoding)));
+            }
+            if (flush) {
+                break; // all input consumed and pivot drained
+            }
+            if (!last && source == sourceLimit) {
+                break; // fragment consumed; partial characters stay in the converter
+            }
+            // else, loop continues to consume remaining input
+        }
+    }
+    output.finish(target);
+}
+
+// Output policy: one contiguous string, doubled whenever it fills up. While growing, the old
+// and the new buffer both count against the memory budget.
+template <typename Alloc>
+class GrowingOutput {
+public:
+    GrowingOutput(BasicOutString<Alloc>& out, const std::size_t initial_capacity)
+        : out_(out), initial_capacity_(std::max<std::size_t>(initial_capacity, 16)) {}
+
+    void start(char*& target, const char*& targetLimit) {
+        const std::size_t capacity = budget_.fit(initial_capacity_, 16);
+        budget_.charge(capacity);
+        resize_output(out_, capacity);
+        target = out_.data();
+        targetLimit = out_.data() + out_.size();
+    }
+
+    void overflow(char*& target, const char*& targetLimit) {
+        // Grow the output buffer and continue.
+        const auto used = static_cast<std::size_t>(target - out_.data());
+        const std::size_t old_capacity = out_.size();
+        const std::size_t wanted = safe_add(safe_multiply(old_capacity, 2u), 16u);
+        const std::size_t grown = budget_.fit(wanted, old_capacity + 16);
+        budget_.charge(grown);
+        resize_output(out_, grown);
+        budget_.release(old_capacity);
+        target = out_.data() + used;
+        targetLimit = out_.data() + out_.size();
+    }
+
+    void finish(char* const target) { out_.resize(static_cast<std::size_t>(target - out_.data())); }
+
+    [[nodiscard]] BudgetTracker* budget() noexcept { return &budget_; }
+
+private:
+    BasicOutString<Alloc>& out_;
+    std::size_t initial_capacity_;
+    BudgetTracker budget_;
+};
+
+// Output policy: a fixed block handed to a sink each time it fills, and once more at the end.
+class BlockSinkOutput {
+public:
+    BlockSinkOutput(const std::size_t block_size, void* const context, const detail::SinkFn emit)
+        : block_(block_size), context_(context), emit_(emit) {}
+
+    void start(char*& target, const char*& targetLimit) {
+        target = block_.data();
+        targetLimit = block_.data() + block_.size();
+    }
+
+    void overflow(char*& target, const char*& targetLimit) {
+        emit(target);
+        start(target, targetLimit);
+    }
+
+    void finish(char* const target) { emit(target); }
+
+    // Bounded by the block size, so not limited by the memory budget.
+    [[nodiscard]] BudgetTracker* budget() noexcept { return nullptr; }
+
+private:
+    void emit(char* const target) {
+        const auto used = static_cast<std::size_t>(target - block_.data());
+        if (used != 0) emit_(context_, std::span<const char>(block_.data(), used));
+    }
+
+    std::vector<char> block_;
+    void* context_;
+    detail::SinkFn emit_;
+};
+
+// Output policy: a MappedBuffer doubled in place by mremap() whenever it fills up.
+class MappedOutput {
+public:
+    MappedOutput(MappedBuffer& out, const std::size_t initial_capacity)
+        : out_(out), initial_capacity_(std::max<std::size_t>(initial_capacity, 16)) {}
+
+    void start(char*& target, const char*& targetLimit) {
+        const std::size_t capacity = budget_.fit(initial_capacity_, 16);
+        budget_.charge(capacity);
+        out_.reserve(capacity);
+        target = out_.data();
+        targetLimit = out_.data() + out_.capacity();
+    }
+
+    void overflow(char*& target, const char*& targetLimit) {
+        // Growing in place: only the added bytes count against the budget.
+        const auto used = static_cast<std::size_t>(target - out_.data());
+        const std::size_t old_capacity = out_.capacity();
+        const std::size_t added = budget_.fit(safe_add(old_capacity, 16u), 16);
+        budget_.charge(added);
+        out_.reserve(old_capacity + added);
+        target = out_.data() + used;
+        targetLimit = out_.data() + out_.capacity();
+    }
+
+    void finish(char* const target) { out_.resize(static_cast<std::size_t>(target - out_.data())); }
+
+    [[nodiscard]] BudgetTracker* budget() noexcept { return &budget_; }
+
+private:
+    MappedBuffer& out_;
+    std::size_t initial_capacity_;
+    BudgetTracker budget_;
+};
+
+/**
+ * Streaming conversion using ICU ucnv_convertEx to avoid allocating a full UTF-16 buffer.
+ *
+ * This function converts incrementally through a small UTF-16 pivot buffer, growing the
+ * output buffer as needed (run_streaming() with a GrowingOutput policy). Converters are
+ * configured to STOP on errors; any invalid input results in an exception rather than
+ * silent substitution.
+ *
+ * Parameters:
+ * - input: the source bytes to convert.
+ * - from_encoding: ICU name (canonical or alias) or resolved Encoding of the source encoding.
+ * - to_encoding: ICU name (canonical or alias) or resolved Encoding of the target encoding.
+ * - initial_out_capacity: heuristic initial size for the output buffer; it will expand if required.
+ * - alloc: allocator of the output buffer, which is also what the buffer grows through.
+ *
+ * Returns the converted bytes.
+ * Throws std::invalid_argument if input.data() is null while input.size() != 0.
+ * Throws std::runtime_error on ICU conversion errors.
+ */
+template <typename Alloc, typename EncodingSpec>
+BasicOutString<Alloc> convert_encoding_streaming(const std::string_view input,
+                                                 const EncodingSpec& from_encoding,
+                                                 const EncodingSpec& to_encoding,
+                                                 const std::size_t initial_out_capacity,
+                                                 const Alloc& alloc) {
+    if (input.data() == nullptr && !input.empty()) {
+        throw std::invalid_argument("convert_encoding_streaming: input is null but size != 0");
+    }
+
+    const ConverterInstance from(resolve_spec(from_encoding));
+    const ConverterInstance to(resolve_spec(to_encoding));
+
+    if (input.size() <= kSmallInputBytes) {
+        BasicOutString<Alloc> small(alloc);
+        if (try_convert_small(from.get(), to.get(), input.data(), input.size(), small)) {
+            return small;
+        }
+    }
+
+    const std::span<const char> fragment(input.data(), input.size());
+
+    // Prepare output buffer with a heuristic initial capacity.
+    BasicOutString<Alloc> out(alloc);
+    GrowingOutput<Alloc> output(out, initial_out_capacity);
+    run_streaming(from.get(), to.get(), std::span(&fragment, 1), output, from_encoding, to_encoding);
+    return out;
+}
+
+template <typename EncodingSpec>
+std::string convert_encoding_streaming(const std::string_view input,
+                                       const EncodingSpec& from_encoding,
+                                       const EncodingSpec& to_encoding,
+                                       const std::size_t initial_out_capacity) {
+    return convert_encoding_streaming(input, from_encoding, to_encoding, initial_out_capacity,
+                                      std::allocator<char>());
+}
+
+std::pmr::polymorphic_allocator<char> pmr_allocator(std::pmr::memory_resource* resource) {
+    return std::pmr::polymorphic_allocator<char>(resource != nullptr ? resource : std::pmr::get_default_resource());
+}
+
+} // namespace
+
+std::size_t detail::ConverterPool::current_shard() const noexcept {
+#if defined(__linux__)
+    if (const int cpu = sched_getcpu(); cpu >= 0) {
+        return static_cast<std::size_t>(cpu) % shard_count_;
+    }
+#endif
+    thread_local const std::size_t thread_hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return thread_hash % shard_count_;
+}
+
+UConverter* detail::ConverterPool::acquire() {
+    const std::size_t home = current_shard();
+    for (std::size_t n = 0; n < shard_count_; ++n) {
+        auto& shard = shards_[(home + n) % shard_count_];
+        for (std::size_t i = 0; i < per_shard_; ++i) {
+            auto& slot = shard.slots[i];
+            if (slot.load(std::memory_order_relaxed) == nullptr) continue;
+            if (UConverter* conv = slot.exchange(nullptr, std::memory_order_acquire)) {
+                shards_[home].hits.fetch_add(1, std::memory_order_relaxed);
+                return conv;
+            }
+        }
+    }
+    shards_[home].misses.fetch_add(1, std::memory_order_relaxed);
+    return clone_converter(encoding_, nullptr, 0);
+}
+
+void detail::ConverterPool::release(UConverter* conv) noexcept {
+    // Drop any partial input or error state left by the previous user.
+    ucnv_reset(conv);
+    auto& shard = shards_[current_shard()];
+    for (std::size_t i = 0; i < per_shard_; ++i) {
+        UConverter* expected = nullptr;
+        if (shard.slots[i].compare_exchange_strong(expected, conv, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    shard.discards.fetch_add(1, std::memory_order_relaxed);
+    ucnv_close(conv);
+}
+
+void detail::ConverterPool::prefill() {
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        for (std::size_t i = 0; i < per_shard_; ++i) {
+            auto& slot = shards_[s].slots[i];
+            if (slot.load(std::memory_order_relaxed) != nullptr) continue;
+            UConverter* conv = clone_converter(encoding_, nullptr, 0);
+            UConverter* expected = nullptr;
+            if (!slot.compare_exchange_strong(expected, conv, std::memory_order_release, std::memory_order_relaxed)) {
+                ucnv_close(conv);
+            }
+        }
+    }
+}
+
+ConverterPoolStats detail::ConverterPool::stats() const noexcept {
+    ConverterPoolStats stats;
+    stats.capacity = shard_count_ * per_shard_;
+    for (std::size_t s = 0; s < shard_count_; ++s) {
+        const auto& shard = shards_[s];
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.discards += shard.discards.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < per_shard_; ++i) {
+            if (shard.slots[i].load(std::memory_order_relaxed) != nullptr) ++stats.depth;
+        }
+    }
+    return stats;
+}
+
+void set_converter_caching(const ConverterCaching caching) noexcept {
+    g_converter_caching.store(caching, std::memory_order_relaxed);
+}
+
+ConverterCaching converter_caching() noexcept {
+    return g_converter_caching.load(std::memory_order_relaxed);
+}
+
+void set_converter_pool_options(const ConverterPoolOptions& options) {
+    std::lock_guard lock(g_pool_options_mutex);
+    g_pool_options = options;
+}
+
+ConverterPoolOptions converter_pool_options() {
+    std::lock_guard lock(g_pool_options_mutex);
+    return g_pool_options;
+}
+
+ConverterPoolStats converter_pool_stats(const Encoding& encoding) {
+    const detail::ConverterPool* pool = encoding.record().pool.load(std::memory_order_acquire);
+    return pool != nullptr ? pool->stats() : ConverterPoolStats{};
+}
+
+MemoryBudgetExceeded::MemoryBudgetExceeded(const std::size_t requested, const std::size_t budget)
+    : std::runtime_error("Conversion needs " + std::to_string(requested) + " bytes, exceeding the memory budget of "
+                         + std::to_string(budget) + " bytes"),
+      requested_(requested),
+      budget_(budget) {}
+
+void set_memory_budget(const std::size_t bytes) noexcept {
+    g_memory_budget.store(bytes, std::memory_order_relaxed);
+}
+
+std::size_t memory_budget() noexcept {
+    return g_memory_budget.load(std::memory_order_relaxed);
+}
+
+ScopedMemoryBudget::ScopedMemoryBudget(const std::size_t bytes) noexcept : previous_(t_memory_budget) {
+    t_memory_budget = bytes;
+}
+
+ScopedMemoryBudget::~ScopedMemoryBudget() {
+    t_memory_budget = previous_;
+}
+
+void set_streaming_options(const StreamingOptions& options) noexcept {
+    g_pivot_units.store(options.pivot_units, std::memory_order_relaxed);
+}
+
+StreamingOptions streaming_options() noexcept {
+    StreamingOptions options;
+    options.pivot_units = g_pivot_units.load(std::memory_order_relaxed);
+    return options;
+}
+
+void set_huge_page_options(const HugePageOptions& options) noexcept {
+    g_huge_pages_enabled.store(options.enabled, std::memory_order_relaxed);
+    g_huge_page_threshold.store(options.threshold_bytes, std::memory_order_relaxed);
+}
+
+HugePageOptions huge_page_options() noexcept {
+    HugePageOptions options;
+    options.enabled = g_huge_pages_enabled.load(std::memory_order_relaxed);
+    options.threshold_bytes = g_huge_page_threshold.load(std::memory_order_relaxed);
+    return options;
+}
+
+std::pmr::memory_resource* huge_page_resource() noexcept {
+    static auto* resource = new HugePageResource(); // leaked: buffers may outlive static destruction
+    return resource;
+}
+
+void set_scratch_buffer_options(const ScratchBufferOptions& options) noexcept {
+    g_scratch_max_retained_bytes.store(options.max_retained_bytes, std::memory_order_relaxed);
+    g_scratch_trim_after_calls.store(options.trim_after_calls, std::memory_order_relaxed);
+}
+
+ScratchBufferOptions scratch_buffer_options() noexcept {
+    ScratchBufferOptions options;
+    options.max_retained_bytes = g_scratch_max_retained_bytes.load(std::memory_order_relaxed);
+    options.trim_after_calls = g_scratch_trim_after_calls.load(std::memory_order_relaxed);
+    return options;
+}
+
+ScratchBufferStats scratch_buffer_stats() noexcept {
+    ScratchBufferStats stats;
+    stats.thread_bytes = thread_scratch().bytes();
+    stats.total_bytes = g_scratch_total_bytes.load(std::memory_order_relaxed);
+    stats.threads = g_scratch_threads.load(std::memory_order_relaxed);
+    stats.reuses = g_scratch_reuses.load(std::memory_order_relaxed);
+    stats.allocations = g_scratch_allocations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void release_thread_scratch_buffer() noexcept {
+    thread_scratch().reset();
+}
+
+void preload(const std::initializer_list<std::string_view> encodings) {
+    for (const std::string_view name : encodings) {
+        preload_encoding(Encoding(name));
+    }
+}
+
+std::future<void> preload_async(std::vector<std::string> encodings) {
+    return std::async(std::launch::async, [names = std::move(encodings)] {
+        for (const std::string& name : names) {
+            preload_encoding(Encoding(name));
+        }
+    });
+}
+
+void initialize(const InitMode mode, const std::initializer_list<std::string_view> encodings) {
+    if (mode == InitMode::lazy) {
+        for (const std::string_view name : encodings) {
+            (void)Encoding(name);
+        }
+        return;
+    }
+    // Fill every known-alias slot too, so children never write to those pages.
+    for (const std::string_view name : kKnownEncodings) {
+        try {
+            preload_encoding(Encoding(name));
+        } catch (const std::runtime_error&) {
+            // Optional: ICU may be built with a reduced converter data set.
+        }
+    }
+    (void)Encoding::utf8();
+    (void)Encoding::big5();
+    for (const std::string_view name : encodings) {
+        preload_encoding(Encoding(name));
+    }
+}
+
+Encoding::Encoding(const std::string_view name)
+    : rec_(&resolve_encoding(name)) {}
+
+Encoding Encoding::utf8() {
+    static const Encoding encoding(kUtf8Name);
+    return encoding;
+}
+
+Encoding Encoding::big5() {
+    static const Encoding encoding(kBig5Name);
+    return encoding;
+}
+
+std::string_view Encoding::name() const noexcept { return rec_->canonical_name; }
+
+std::uint32_t Encoding::id() const noexcept { return rec_->id; }
+
+EncodingFlags Encoding::flags() const noexcept { return rec_->flags; }
+
+int Encoding::max_char_size() const noexcept { return rec_->max_char_size; }
+
+std::string convert_encoding(const std::string_view input,
+                             const std::string_view from_encoding,
+                             const std::string_view to_encoding) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, to_encoding);
+}
+
+std::string to_utf8(const std::string_view input, const std::string_view from_encoding) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, kUtf8Name);
+}
+
+std::string from_utf8(const std::string_view utf8, const std::string_view to_encoding) {
+    return convert_encoding_impl(utf8.data(), safe_size_to_int32(utf8.size()), kUtf8Name, to_encoding);
+}
+
+std::string convert_encoding(const std::string_view input,
+                             const Encoding& from_encoding,
+                             const Encoding& to_encoding) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, to_encoding);
+}
+
+std::string to_utf8(const std::string_view input, const Encoding& from_encoding) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, Encoding::utf8());
+}
+
+std::string from_utf8(const std::string_view utf8, const Encoding& to_encoding) {
+    return convert_encoding_impl(utf8.data(), safe_size_to_int32(utf8.size()), Encoding::utf8(), to_encoding);
+}
+
+std::string big5_to_utf8(const std::string_view big5_bytes) {
+    return to_utf8(big5_bytes, Encoding::big5());
+}
+
+std::string utf8_to_big5(const std::string_view utf8) {
+    return from_utf8(utf8, Encoding::big5());
+}
+
+std::string big5_to_utf8_dr(const std::string_view big5_bytes) {
+    // Sized from the input's byte mix instead of the 3x worst case
+    const std::size_t guess = budgeted_estimate(big5_bytes, Encoding::big5(), Encoding::utf8());
+    return convert_encoding_streaming(big5_bytes, Encoding::big5(), Encoding::utf8(), guess);
+}
+
+std::string utf8_to_big5_dr(const std::string_view utf8) {
+    // Sized from the input's byte mix instead of the 2x worst case
+    const std::size_t guess = budgeted_estimate(utf8, Encoding::utf8(), Encoding::big5());
+    return convert_encoding_streaming(utf8, Encoding::utf8(), Encoding::big5(), guess);
+}
+
+std::size_t estimate_output_size(const std::string_view input,
+                                 const Encoding& from_encoding,
+                                 const Encoding& to_encoding) noexcept {
+    return estimate_output(input, from_encoding, to_encoding);
+}
+
+std::string convert_encoding(const char* input,
+                             const std::string_view from_encoding,
+                             const std::string_view to_encoding) {
+    return convert_encoding_impl(input, -1, from_encoding, to_encoding);
+}
+
+std::string to_utf8(const char* input, const std::string_view from_encoding) {
+    return convert_encoding_impl(input, -1, from_encoding, kUtf8Name);
+}
+
+std::string from_utf8(const char* utf8, const std::string_view to_encoding) {
+    return convert_encoding_impl(utf8, -1, kUtf8Name, to_encoding);
+}
+
+std::string convert_encoding(const char* input, const std::size_t length,
+                             const std::string_view from_encoding,
+                             const std::string_view to_encoding) {
+    return convert_encoding_impl(input, safe_size_to_int32(length), from_encoding, to_encoding);
+}
+
+std::string to_utf8(const char* input, const std::size_t length, const std::string_view from_encoding) {
+    return convert_encoding_impl(input, safe_size_to_int32(length), from_encoding, kUtf8Name);
+}
+
+std::string from_utf8(const char* utf8, const std::size_t length, const std::string_view to_encoding) {
+    return convert_encoding_impl(utf8, safe_size_to_int32(length), kUtf8Name, to_encoding);
+}
+
+// Big5 helpers (C-style, null-terminated)
+std::string big5_to_utf8(const char* big5_bytes) {
+    return convert_encoding_impl(big5_bytes, -1, Encoding::big5(), Encoding::utf8());
+}
+
+std::string utf8_to_big5(const char* utf8) {
+    return convert_encoding_impl(utf8, -1, Encoding::utf8(), Encoding::big5());
+}
+
+std::string big5_to_utf8_dr(const char* big5_bytes) {
+    if (big5_bytes == nullptr) {
+        throw std::invalid_argument("big5_to_utf8_dr: input is null");
+    }
+    return big5_to_utf8_dr(std::string_view(big5_bytes));
+}
+
+std::string utf8_to_big5_dr(const char* utf8) {
+    if (utf8 == nullptr) {
+        throw std::invalid_argument("utf8_to_big5_dr: input is null");
+    }
+    return utf8_to_big5_dr(std::string_view(utf8));
+}
+
+// Big5 helpers (C-style with explicit length)
+std::string big5_to_utf8(const char* big5_bytes, const std::size_t length) {
+    return convert_encoding_impl(big5_bytes, safe_size_to_int32(length), Encoding::big5(), Encoding::utf8());
+}
+
+std::string utf8_to_big5(const char* utf8, const std::size_t length) {
+    return convert_encoding_impl(utf8, safe_size_to_int32(length), Encoding::utf8(), Encoding::big5());
+}
+
+std::string big5_to_utf8_dr(const char* big5_bytes, const std::size_t length) {
+    if (big5_bytes == nullptr) {
+        if (length == 0) return {};
+        throw std::invalid_argument("big5_to_utf8_dr: input is null");
+    }
+    return big5_to_utf8_dr(std::string_view(big5_bytes, length));
+}
+
+std::string utf8_to_big5_dr(const char* utf8, const std::size_t length) {
+    if (utf8 == nullptr) {
+        if (length == 0) return {};
+        throw std::invalid_argument("utf8_to_big5_dr: input is null");
+    }
+    return utf8_to_big5_dr(std::string_view(utf8, length));
+}
+
+bool can_convert_in_place(const Encoding& from_encoding, const Encoding& to_encoding) noexcept {
+    // Per UTF-8 sequence: 1 byte (ASCII) -> 1 byte; 2-3 bytes -> one UTF-16 unit -> <= 2 bytes;
+    // 4 bytes -> two units -> <= 4 bytes. Output derives only from consumed input, so the
+    // write position can never pass the read position.
+    if (!from_encoding.has(EncodingFlags::utf8)) return false;
+    if (to_encoding.has(EncodingFlags::utf8)) return true;
+    return to_encoding.has(EncodingFlags::ascii_compatible) && !to_encoding.has(EncodingFlags::stateful)
+        && to_encoding.max_char_size() <= 2;
+}
+
+void convert_in_place(std::string& buf, const Encoding& from_encoding, const Encoding& to_encoding) {
+    if (!can_convert_in_place(from_encoding, to_encoding)) {
+        throw std::invalid_argument("convert_in_place: output may outgrow input for " + std::string(from_encoding.name())
+                                    + " -> " + std::string(to_encoding.name()));
+    }
+    if (buf.empty()) return;
+
+    const ConverterInstance from(from_encoding);
+    const ConverterInstance to(to_encoding);
+    const auto fail = [&](const char* step) {
+        buf.clear();
+        throw std::runtime_error(std::string("ICU ") + step + " failed for " + std::string(from_encoding.name()) + " -> "
+                                 + std::string(to_encoding.name()));
+    };
+
+    char* const base = buf.data();
+    const char* source = base;
+    const char* const sourceLimit = base + buf.size();
+    char* target = base;
+
+    // Only used if ICU ever produces more than it consumed; then the rest is converted out of place.
+    std::string spill;
+    std::size_t spilled = 0;
+
+    UChar pivot[1024];
+    for (;;) {
+        // Decode as much input as fits the pivot; everything decoded is now free to overwrite.
+        UChar* pivotTarget = pivot;
+        UErrorCode status = U_ZERO_ERROR;
+        ucnv_toUnicode(from.get(), &pivotTarget, pivot + std::size(pivot), &source, sourceLimit, nullptr,
+                       /*flush*/ 1, &status);
+        if (U_FAILURE(status) && status != U_BUFFER_OVERFLOW_ERROR) fail("ucnv_toUnicode");
+        const bool last = status != U_BUFFER_OVERFLOW_ERROR;
+
+        const UChar* pivotSource = pivot;
+        for (;;) {
+            status = U_ZERO_ERROR;
+            if (spill.empty()) {
+                ucnv_fromUnicode(to.get(), &target, source, &pivotSource, pivotTarget, nullptr, last, &status);
+                if (status == U_BUFFER_OVERFLOW_ERROR) {
+                    spill.resize(std::max<std::size_t>(64, static_cast<std::size_t>(sourceLimit - source) * 2));
+                    continue;
+                }
+            } else {
+                char* spillTarget = spill.data() + spilled;
+                ucnv_fromUnicode(to.get(), &spillTarget, spill.data() + spill.size(), &pivotSource, pivotTarget,
+                                 nullptr, last, &status);
+                spilled = static_cast<std::size_t>(spillTarget - spill.data());
+                if (status == U_BUFFER_OVERFLOW_ERROR) {
+                    spill.resize(safe_multiply(spill.size(), 2u));
+                    continue;
+                }
+            }
+            if (U_FAILURE(status)) fail("ucnv_fromUnicode");
+            break;
+        }
+        if (last) break;
+    }
+
+    buf.resize(static_cast<std::size_t>(target - base));
+    buf.append(spill.data(), spilled);
+}
+
+void convert_in_place(std::string& buf, const std::string_view from_encoding, const std::string_view to_encoding) {
+    convert_in_place(buf, Encoding(from_encoding), Encoding(to_encoding));
+}
+
+void utf8_to_big5_in_place(std::string& buf) {
+    convert_in_place(buf, Encoding::utf8(), Encoding::big5());
+}
+
+// Output sinks
+
+void detail::convert_to_sink(const std::span<const std::span<const char>> fragments,
+                             const Encoding& from_encoding,
+                             const Encoding& to_encoding,
+                             const std::size_t block_size,
+                             void* const context,
+                             const SinkFn emit) {
+    if (block_size < kMinSinkBlockSize) {
+        throw std::invalid_argument("convert_encoding_to: block_size is below kMinSinkBlockSize");
+    }
+    const ConverterInstance from(from_encoding);
+    const ConverterInstance to(to_encoding);
+    BlockSinkOutput output(block_size, context, emit);
+    run_streaming(from.get(), to.get(), fragments, output, from_encoding, to_encoding);
+}
+
+// Mapped output
+
+namespace {
+
+std::size_t round_up_to_page(const std::size_t bytes) {
+    static const std::size_t page = [] {
+#if defined(__unix__) || defined(__APPLE__)
+        const long size = sysconf(_SC_PAGESIZE);
+        return size > 0 ? static_cast<std::size_t>(size) : std::size_t{4096};
+#else
+        return std::size_t{4096};
+#endif
+    }();
+    return safe_add(bytes, page - 1) & ~(page - 1);
+}
+
+} // namespace
+
+MappedBuffer::MappedBuffer(const std::size_t capacity) {
+    reserve(capacity);
+}
+
+MappedBuffer::MappedBuffer(MappedBuffer&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      capacity_(std::exchange(other.capacity_, 0)) {}
+
+MappedBuffer& MappedBuffer::operator=(MappedBuffer&& other) noexcept {
+    if (this != &other) {
+        MappedBuffer old(std::move(*this));
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+    }
+    return *this;
+}
+
+MappedBuffer::~MappedBuffer() {
+    if (data_ == nullptr) return;
+#if defined(__linux__)
+    munmap(data_, capacity_);
+#else
+    std::free(data_);
+#endif
+}
+
+void MappedBuffer::reserve(const std::size_t capacity) {
+    if (capacity <= capacity_) return;
+    const std::size_t length = round_up_to_page(capacity);
+#if defined(__linux__)
+    void* const grown = data_ == nullptr
+                            ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+                            : mremap(data_, capacity_, length, MREMAP_MAYMOVE);
+    if (grown == MAP_FAILED) throw std::bad_alloc();
+#else
+    void* const grown = std::realloc(data_, length);
+    if (grown == nullptr) throw std::bad_alloc();
+#endif
+    data_ = static_cast<char*>(grown);
+    if (wants_huge_pages(length)) advise_huge_pages(data_ + capacity_, length - capacity_);
+    capacity_ = length;
+}
+
+void MappedBuffer::resize(const std::size_t size) {
+    reserve(size);
+    size_ = size;
+}
+
+MappedBuffer convert_mapped(const std::string_view input, const Encoding& from_encoding, const Encoding& to_encoding) {
+    const ConverterInstance from(from_encoding);
+    const ConverterInstance to(to_encoding);
+    MappedBuffer out;
+    MappedOutput output(out, budgeted_estimate(input, from_encoding, to_encoding));
+    const std::span<const char> fragment(input.data(), input.size());
+    run_streaming(from.get(), to.get(), std::span(&fragment, 1), output, from_encoding, to_encoding);
+    return out;
+}
+
+MappedBuffer big5_to_utf8_mapped(const std::string_view big5_bytes) {
+    return convert_mapped(big5_bytes, Encoding::big5(), Encoding::utf8());
+}
+
+MappedBuffer utf8_to_big5_mapped(const std::string_view utf8) {
+    return convert_mapped(utf8, Encoding::utf8(), Encoding::big5());
+}
+
+// Chunk generators
+
+// Incremental ucnv_convertEx session behind detail::Transcoder: each convert() converts the
+// current input into the chunk buffer, stopping whenever the buffer fills so it can be handed out.
+class detail::Transcoder::Impl {
+public:
+    Impl(const Encoding& from_encoding, const Encoding& to_encoding, const std::size_t chunk_size)
+        : from_encoding_(from_encoding),
+          to_encoding_(to_encoding),
+          from_(from_encoding),
+          to_(to_encoding),
+          chunk_(chunk_size),
+          pivot_units_(pivot_units_for(chunk_.size())),
+          pivot_(std::make_unique_for_overwrite<UChar[]>(pivot_units_)),
+          pivotSource_(pivot_.get()),
+          pivotTarget_(pivot_.get()),
+          target_(chunk_.data()) {}
+
+    void start_input(const char* data, const std::size_t size, const bool last) noexcept {
+        static constexpr char kEmpty = '\0'; // ICU rejects a null source even when empty
+        source_ = size == 0 ? &kEmpty : data;
+        sourceLimit_ = source_ + size;
+        last_ = last;
+    }
+
+    // Converts until the chunk is full (true: take_chunk() and call again) or the current input is
+    // consumed (false; with the last input also flushed).
+    bool convert() {
+        for (;;) {
+            UErrorCode status = U_ZERO_ERROR;
+            const UBool flush = (last_ && source_ == sourceLimit_) ? 1 : 0;
+            ucnv_convertEx(to_.get(), from_.get(), &target_, chunk_.data() + chunk_.size(), &source_, sourceLimit_,
+                           pivot_.get(), &pivotSource_, &pivotTarget_, pivot_.get() + pivot_units_, reset_ ? 1 : 0,
+                           flush, &status);
+            reset_ = false;
+            if (status == U_BUFFER_OVERFLOW_ERROR) return true;
+            if (U_FAILURE(status)) {
+                throw std::runtime_error("ICU ucnv_convertEx failed for " + std::string(from_encoding_.name()) + " -> "
+                                         + std::string(to_encoding_.name()));
+            }
+            if (flush || source_ == sourceLimit_) return false;
+        }
+    }
+
+    [[nodiscard]] bool has_output() const noexcept { return target_ != chunk_.data(); }
+
+    // The converted bytes so far; the buffer is reused once conversion continues.
+    std::span<const char> take_chunk() noexcept {
+        const std::span<const char> chunk(chunk_.data(), static_cast<std::size_t>(target_ - chunk_.data()));
+        target_ = chunk_.data();
+        return chunk;
+    }
+
+private:
+    Encoding from_encoding_;
+    Encoding to_encoding_;
+    ConverterInstance from_;
+    ConverterInstance to_;
+    std::vector<char> chunk_;
+    std::size_t pivot_units_;
+    std::unique_ptr<UChar[]> pivot_;
+    UChar* pivotSource_;
+    UChar* pivotTarget_;
+    char* target_;
+    const char* source_ = nullptr;
+    const char* sourceLimit_ = nullptr;
+    bool last_ = true;
+    bool reset_ = true;
+};
+
+detail::Transcoder::Transcoder(const Encoding& from_encoding, const Encoding& to_encoding, const std::size_t chunk_size) {
+    if (chunk_size < kMinSinkBlockSize) {
+        throw std::invalid_argument("Transcoder: chunk_size is below kMinSinkBlockSize");
+    }
+    impl_ = std::make_unique<Impl>(from_encoding, to_encoding, chunk_size);
+}
+
+detail::Transcoder::Transcoder(Transcoder&&) noexcept = default;
+detail::Transcoder& detail::Transcoder::operator=(Transcoder&&) noexcept = default;
+detail::Transcoder::~Transcoder() = default;
+
+void detail::Transcoder::start_input(const char* data, const std::size_t size, const bool last) noexcept {
+    impl_->start_input(data, size, last);
+}
+
+bool detail::Transcoder::convert() {
+    return impl_->convert();
+}
+
+bool detail::Transcoder::has_output() const noexcept {
+    return impl_->has_output();
+}
+
+std::span<const char> detail::Transcoder::take_chunk() noexcept {
+    return impl_->take_chunk();
+}
+
+namespace {
+
+// The coroutine bodies of convert_chunks(); arguments are validated eagerly by the callers,
+// since anything thrown here would only surface at begin().
+ChunkGenerator generate_chunks(const std::string_view input,
+                               const Encoding from_encoding,
+                               const Encoding to_encoding,
+                               const std::size_t chunk_size) {
+    detail::Transcoder session(from_encoding, to_encoding, chunk_size);
+    session.start_input(input.data(), input.size(), /*last*/ true);
+    while (session.convert()) co_yield session.take_chunk();
+    if (session.has_output()) co_yield session.take_chunk();
+}
+
+ChunkGenerator generate_chunks(std::istream& in,
+                               const Encoding from_encoding,
+                               const Encoding to_encoding,
+                               const std::size_t chunk_size) {
+    detail::Transcoder session(from_encoding, to_encoding, chunk_size);
+    std::vector<char> block(chunk_size);
+    for (;;) {
+        in.read(block.data(), static_cast<std::streamsize>(block.size()));
+        const auto got = static_cast<std::size_t>(in.gcount());
+        if (in.bad()) throw std::runtime_error("convert_chunks: read error");
+        const bool last = got < block.size();
+        session.start_input(block.data(), got, last);
+        while (session.convert()) co_yield session.take_chunk();
+        if (last) break;
+    }
+    if (session.has_output()) co_yield session.take_chunk();
+}
+
+void check_chunk_size(const std::size_t chunk_size) {
+    if (chunk_size < kMinSinkBlockSize) {
+        throw std::invalid_argument("convert_chunks: chunk_size is below kMinSinkBlockSize");
+    }
+}
+
+} // namespace
+
+ChunkGenerator convert_chunks(const std::string_view input,
+                              const Encoding from_encoding,
+                              const Encoding to_encoding,
+                              const std::size_t chunk_size) {
+    check_chunk_size(chunk_size);
+    return generate_chunks(input, from_encoding, to_encoding, chunk_size);
+}
+
+ChunkGenerator convert_chunks(std::istream& in,
+                              const Encoding from_encoding,
+                              const Encoding to_encoding,
+                              const std::size_t chunk_size) {
+    check_chunk_size(chunk_size);
+    return generate_chunks(in, from_encoding, to_encoding, chunk_size);
+}
+
+// Segmented output
+
+namespace {
+
+constexpr std::size_t kMaxPooledBlocks = 64; // retains at most 4 MiB of idle blocks
+
+class BlockPool {
+public:
+    char* acquire() {
+        {
+            const std::lock_guard lock(mutex_);
+            if (!free_.empty()) {
+                char* block = free_.back();
+                free_.pop_back();
+                return block;
+            }
+        }
+        return new char[SegmentedOutput::kBlockSize];
+    }
+
+    void release(char* const block) noexcept {
+        {
+            const std::lock_guard lock(mutex_);
+            if (free_.size() < kMaxPooledBlocks) {
+                try {
+                    free_.push_back(block);
+                    return;
+                } catch (...) {
+                }
+            }
+        }
+        delete[] block;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<char*> free_;
+};
+
+BlockPool& block_pool() {
+    static auto* pool = new BlockPool(); // leaked: outputs may be destroyed during static destruction
+    return *pool;
+}
+
+} // namespace
+
+// Output policy: appends pooled blocks to a SegmentedOutput as they fill.
+class detail::SegmentedWriter {
+public:
+    explicit SegmentedWriter(SegmentedOutput& out) : out_(out) {}
+
+    void start(char*& target, const char*& targetLimit) { next_block(target, targetLimit); }
+
+    void overflow(char*& target, const char*& targetLimit) {
+        commit(target);
+        next_block(target, targetLimit);
+    }
+
+    void finish(char* const target) {
+        commit(target);
+        // Blocks are never left empty.
+        if (!out_.blocks_.empty() && out_.blocks_.back().empty()) {
+            block_pool().release(block_);
+            out_.blocks_.pop_back();
+        }
+    }
+
+    [[nodiscard]] BudgetTracker* budget() noexcept { return &budget_; }
+
+private:
+    void next_block(char*& target, const char*& targetLimit) {
+        budget_.charge(SegmentedOutput::kBlockSize);
+        // Reserve ahead (geometrically) so the emplace_back below cannot throw once a block is held.
+        if (out_.blocks_.size() == out_.blocks_.capacity()) {
+            out_.blocks_.reserve(std::max<std::size_t>(8, 2 * out_.blocks_.capacity()));
+        }
+        block_ = block_pool().acquire();
+        out_.blocks_.emplace_back(block_, 0);
+        target = block_;
+        targetLimit = block_ + SegmentedOutput::kBlockSize;
+    }
+
+    void commit(char* const target) noexcept {
+        const auto used = static_cast<std::size_t>(target - block_);
+        out_.blocks_.back() = std::span<const char>(block_, used);
+        out_.size_ += used;
+    }
+
+    SegmentedOutput& out_;
+    char* block_ = nullptr;
+    BudgetTracker budget_;
+};
+
+SegmentedOutput::SegmentedOutput(SegmentedOutput&& other) noexcept
+    : blocks_(std::move(other.blocks_)), size_(std::exchange(other.size_, 0)) {
+    other.blocks_.clear();
+}
+
+SegmentedOutput& SegmentedOutput::operator=(SegmentedOutput&& other) noexcept {
+    if (this != &other) {
+        release();
+        blocks_ = std::move(other.blocks_);
+        size_ = std::exchange(other.size_, 0);
+        other.blocks_.clear();
+    }
+    return *this;
+}
+
+SegmentedOutput::~SegmentedOutput() {
+    release();
+}
+
+void SegmentedOutput::release() noexcept {
+    for (const auto& block : blocks_) block_pool().release(const_cast<char*>(block.data()));
+    blocks_.clear();
+    size_ = 0;
+}
+
+#if UTF8ANSI_HAS_IOVEC
+std::vector<iovec> SegmentedOutput::iovecs() const {
+    std::vector<iovec> out;
+    out.reserve(blocks_.size());
+    for (const auto& block : blocks_) out.push_back(iovec{const_cast<char*>(block.data()), block.size()});
+    return out;
+}
+#endif
+
+std::string SegmentedOutput::str() const {
+    std::string out;
+    out.reserve(size_);
+    for (const auto& block : blocks_) out.append(block.data(), block.size());
+    return out;
+}
+
+SegmentedOutput convert_segmented(const std::string_view input,
+                                  const Encoding& from_encoding,
+                                  const Encoding& to_encoding) {
+    if (effective_memory_budget() != kUnlimitedMemoryBudget) (void)budgeted_estimate(input, from_encoding, to_encoding);
+
+    const ConverterInstance from(from_encoding);
+    const ConverterInstance to(to_encoding);
+    SegmentedOutput out;
+    detail::SegmentedWriter writer(out);
+    const std::span<const char> fragment(input.data(), input.size());
+    run_streaming(from.get(), to.get(), std::span(&fragment, 1), writer, from_encoding, to_encoding);
+    return out;
+}
+
+SegmentedOutput big5_to_utf8_segmented(const std::string_view big5_bytes) {
+    return convert_segmented(big5_bytes, Encoding::big5(), Encoding::utf8());
+}
+
+SegmentedOutput utf8_to_big5_segmented(const std::string_view utf8) {
+    return convert_segmented(utf8, Encoding::utf8(), Encoding::big5());
+}
+
+// Scatter-gather input
+
+std::string convert_fragments(const std::span<const std::span<const char>> fragments,
+                              const Encoding& from_encoding,
+                              const Encoding& to_encoding) {
+    std::size_t minimum = 0;
+    std::size_t estimate = 0;
+    for (const auto& fragment : fragments) {
+        if (fragment.data() == nullptr && !fragment.empty()) {
+            throw std::invalid_argument("convert_fragments: fragment is null but size != 0");
+        }
+        const OutputBounds bounds =
+            output_bounds(std::string_view(fragment.data(), fragment.size()), from_encoding, to_encoding);
+        minimum = safe_add(minimum, bounds.minimum);
+        estimate = safe_add(estimate, bounds.estimate);
+    }
+    require_budget_for(minimum);
+
+    const ConverterInstance from(from_encoding);
+    const ConverterInstance to(to_encoding);
+    std::string out;
+    GrowingOutput<std::allocator<char>> output(out, estimate);
+    run_streaming(from.get(), to.get(), fragments, output, from_encoding, to_encoding);
+    return out;
+}
+
+std::string big5_to_utf8_dr(const std::span<const std::span<const char>> fragments) {
+    return convert_fragments(fragments, Encoding::big5(), Encoding::utf8());
+}
+
+std::string utf8_to_big5_dr(const std::span<const std::span<const char>> fragments) {
+    return convert_fragments(fragments, Encoding::utf8(), Encoding::big5());
+}
+
+#if UTF8ANSI_HAS_IOVEC
+namespace {
+
+std::vector<std::span<const char>> iovec_fragments(const std::span<const iovec> fragments) {
+    std::vector<std::span<const char>> out;
+    out.reserve(fragments.size());
+    for (const iovec& fragment : fragments) {
+        out.emplace_back(static_cast<const char*>(fragment.iov_base), fragment.iov_len);
+    }
+    return out;
+}
+
+} // namespace
+
+std::string convert_fragments(const std::span<const iovec> fragments,
+                              const Encoding& from_encoding,
+                              const Encoding& to_encoding) {
+    return convert_fragments(iovec_fragments(fragments), from_encoding, to_encoding);
+}
+#endif
+
+// Batch conversion
+
+DedupedBatch convert_batch_deduplicated(const std::span<const std::string_view> inputs,
+                                        const Encoding& from_encoding,
+                                        const Encoding& to_encoding) {
+    if (inputs.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Batch too large");
+    }
+    DedupedBatch batch;
+    batch.index.reserve(inputs.size());
+    std::unordered_map<std::string_view, std::uint32_t> seen;
+    seen.reserve(inputs.size());
+    for (const std::string_view input : inputs) {
+        const auto [it, inserted] = seen.try_emplace(input, static_cast<std::uint32_t>(batch.values.size()));
+        if (inserted) batch.values.push_back(convert_encoding(input, from_encoding, to_encoding));
+        batch.index.push_back(it->second);
+    }
+    return batch;
+}
+
+std::vector<std::string> convert_batch(const std::span<const std::string_view> inputs,
+                                       const Encoding& from_encoding,
+                                       const Encoding& to_encoding) {
+    DedupedBatch batch = convert_batch_deduplicated(inputs, from_encoding, to_encoding);
+    std::vector<std::string> out;
+    out.reserve(batch.size());
+    // The last occurrence of each value takes ownership of the converted string.
+    std::vector<std::size_t> last(batch.values.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) last[batch.index[i]] = i;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        std::string& value = batch.values[batch.index[i]];
+        out.push_back(last[batch.index[i]] == i ? std::move(value) : value);
+    }
+    return out;
+}
+
+std::vector<std::string> big5_to_utf8_batch(const std::span<const std::string_view> big5_values) {
+    return convert_batch(big5_values, Encoding::big5(), Encoding::utf8());
+}
+
+std::vector<std::string> utf8_to_big5_batch(const std::span<const std::string_view> utf8_values) {
+    return convert_batch(utf8_values, Encoding::utf8(), Encoding::big5());
+}
+
+// Deferred conversion
+
+lazy_converted::lazy_converted(std::string source, const Encoding& from_encoding, const Encoding& to_encoding)
+    : source_(std::move(source)), from_(from_encoding), to_(to_encoding) {}
+
+lazy_converted lazy_converted::from_big5(std::string big5_bytes) {
+    return lazy_converted(std::move(big5_bytes), Encoding::big5(), Encoding::utf8());
+}
+
+lazy_converted::lazy_converted(lazy_converted&& other) noexcept
+    : source_(std::move(other.source_)),
+      from_(other.from_),
+      to_(other.to_),
+      state_(other.state_.load(std::memory_order_acquire)),
+      result_(std::move(other.result_)),
+      error_(std::move(other.error_)) {}
+
+lazy_converted& lazy_converted::operator=(lazy_converted&& other) noexcept {
+    if (this != &other) {
+        source_ = std::move(other.source_);
+        from_ = other.from_;
+        to_ = other.to_;
+        state_.store(other.state_.load(std::memory_order_acquire), std::memory_order_release);
+        result_ = std::move(other.result_);
+        error_ = std::move(other.error_);
+    }
+    return *this;
+}
+
+const std::string& lazy_converted::get() const {
+    std::uint8_t state = state_.load(std::memory_order_acquire);
+    if (state == kPending && state_.compare_exchange_strong(state, kRunning, std::memory_order_acquire)) {
+        try {
+            result_ = convert_encoding(source_, from_, to_);
+            state = kDone;
+        } catch (...) {
+            error_ = std::current_exception();
+            state = kFailed;
+        }
+        state_.store(state, std::memory_order_release);
+        state_.notify_all();
+    }
+    while (state == kRunning || state == kPending) {
+        state_.wait(kRunning, std::memory_order_acquire);
+        state = state_.load(std::memory_order_acquire);
+    }
+    if (state == kFailed) std::rethrow_exception(error_);
+    return result_;
+}
+
+bool lazy_converted::converted() const noexcept {
+    const auto state = state_.load(std::memory_order_acquire);
+    return state == kDone || state == kFailed;
+}
+
+// std::pmr overloads
+
+std::pmr::string convert_encoding(const std::string_view input,
+                                  const std::string_view from_encoding,
+                                  const std::string_view to_encoding,
+                                  std::pmr::memory_resource* resource) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, to_encoding,
+                                 pmr_allocator(resource));
+}
+
+std::pmr::string convert_encoding(const std::string_view input,
+                                  const Encoding& from_encoding,
+                                  const Encoding& to_encoding,
+                                  std::pmr::memory_resource* resource) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, to_encoding,
+                                 pmr_allocator(resource));
+}
+
+std::pmr::string to_utf8(const std::string_view input, const std::string_view from_encoding,
+                         std::pmr::memory_resource* resource) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, kUtf8Name,
+                                 pmr_allocator(resource));
+}
+
+std::pmr::string to_utf8(const std::string_view input, const Encoding& from_encoding,
+                         std::pmr::memory_resource* resource) {
+    return convert_encoding_impl(input.data(), safe_size_to_int32(input.size()), from_encoding, Encoding::utf8(),
+                                 pmr_allocator(resource));
+}
+
+std::pmr::string from_utf8(const std::string_view utf8, const std::string_view to_encoding,
+                           std::pmr::memory_resource* resource) {
+    return convert_encoding_impl(utf8.data(), safe_size_to_int32(utf8.size()), kUtf8Name, to_encoding,
+                                 pmr_allocator(resource));
+}
+
+std::pmr::string from_utf8(const std::string_view utf8, const Encoding& to_encoding,
+                           std::pmr::memory_resource* resource) {
+    return convert_encoding_impl(utf8.data(), safe_size_to_int32(utf8.size()), Encoding::utf8(), to_encoding,
+                                 pmr_allocator(resource));
+}
+
+std::pmr::string big5_to_utf8(const std::string_view big5_bytes, std::pmr::memory_resource* resource) {
+    return to_utf8(big5_bytes, Encoding::big5(), resource);
+}
+
+std::pmr::string utf8_to_big5(const std::string_view utf8, std::pmr::memory_resource* resource) {
+    return from_utf8(utf8, Encoding::big5(), resource);
+}
+
+std::pmr::string big5_to_utf8_dr(const std::string_view big5_bytes, std::pmr::memory_resource* resource) {
+    const std::size_t guess = budgeted_estimate(big5_bytes, Encoding::big5(), Encoding::utf8());
+    return convert_encoding_streaming(big5_bytes, Encoding::big5(), Encoding::utf8(), guess, pmr_allocator(resource));
+}
+
+std::pmr::string utf8_to_big5_dr(const std::string_view utf8, std::pmr::memory_resource* resource) {
+    const std::size_t guess = budgeted_estimate(utf8, Encoding::utf8(), Encoding::big5());
+    return convert_encoding_streaming(utf8, Encoding::utf8(), Encoding::big5(), guess, pmr_allocator(resource));
+}
+
+// -----------------------------------------------------------------------------
+// Asynchronous conversion
+// -----------------------------------------------------------------------------
+
+namespace {
+
+std::atomic<std::size_t> g_async_threads{AsyncOptions{}.threads};
+
+class WorkerPool {
+public:
+    explicit WorkerPool(std::size_t threads) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+        workers_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) workers_.emplace_back([this] { run(); });
+    }
+
+    void submit(std::packaged_task<void()> task) {
+        {
+            const std::lock_guard lock(mutex_);
+            queue_.push_back(std::move(task));
+        }
+        ready_.notify_one();
+    }
+
+private:
+    void run() {
+        for (;;) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                ready_.wait(lock, [this] { return !queue_.empty(); });
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task(); // exceptions are stored in the task's future
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::packaged_task<void()>> queue_;
+    std::vector<std::thread> workers_;
+};
+
+WorkerPool& worker_pool() {
+    // Leaked: workers may still be running or idle when static destructors run.
+    static auto* pool = new WorkerPool(g_async_threads.load(std::memory_order_relaxed));
+    return *pool;
+}
+
+} // namespace
+
+void set_async_options(const AsyncOptions& options) noexcept {
+    g_async_threads.store(options.threads, std::memory_order_relaxed);
+}
+
+std::future<std::string> convert_async(std::string input, const Encoding& from_encoding, const Encoding& to_encoding) {
+    std::packaged_task<std::string()> convert(
+        [input = std::move(input), from_encoding, to_encoding, budget = effective_memory_budget()] {
+            const ScopedMemoryBudget scope(budget);
+            return convert_encoding_streaming(input, from_encoding, to_encoding,
+                                              budgeted_estimate(input, from_encoding, to_encoding));
+        });
+    std::future<std::string> result = convert.get_future();
+    worker_pool().submit(std::packaged_task<void()>([convert = std::move(convert)]() mutable { convert(); }));
+    return result;
+}
+
+std::future<std::string> big5_to_utf8_async(std::string big5_bytes) {
+    return convert_async(std::move(big5_bytes), Encoding::big5(), Encoding::utf8());
+}
+
+std::future<std::string> utf8_to_big5_async(std::string utf8) {
+    return convert_async(std::move(utf8), Encoding::utf8(), Encoding::big5());
+}
+
+// -----------------------------------------------------------------------------
+// Conversion cache
+// -----------------------------------------------------------------------------
+
+namespace {
+
+// Bookkeeping charged per entry on top of its input and output bytes (list node, map node,
+// shared_ptr control block).
+constexpr std::size_t kCacheEntryOverhead = 128;
+
+struct CacheKey {
+    std::uint32_t from;
+    std::uint32_t to;
+    std::uint64_t hash;
+    std::string_view bytes; // points into the entry's own copy once inserted
+
+    friend bool operator==(const CacheKey& a, const CacheKey& b) noexcept {
+        return a.hash == b.hash && a.from == b.from && a.to == b.to && a.bytes == b.bytes;
+    }
+};
+
+struct CacheKeyHash {
+    std::size_t operator()(const CacheKey& key) const noexcept { return static_cast<std::size_t>(key.hash); }
+};
+
+struct CacheEntry {
+    std::string input;
+    std::uint32_t from;
+    std::uint32_t to;
+    std::uint64_t hash;
+    std::shared_ptr<const std::string> output;
+
+    [[nodiscard]] std::size_t charge() const noexcept { return input.size() + output->size() + kCacheEntryOverhead; }
+};
+
+struct CacheShard {
+    mutable std::mutex mutex;
+    std::list<CacheEntry> lru; // most recently used first
+    std::unordered_map<CacheKey, std::list<CacheEntry>::iterator, CacheKeyHash> index;
+    std::size_t bytes = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+};
+
+} // namespace
+
+struct ConversionCache::Impl {
+    std::size_t max_entry_bytes;
+    std::size_t shard_budget;
+    std::unique_ptr<CacheShard[]> shards;
+    std::size_t shard_count;
+    std::atomic<std::uint64_t> bypasses{0};
+
+    CacheShard& shard_for(const std::uint64_t hash) noexcept {
+        // The low bits pick the hash table bucket. Fold every bit into the top ones for the shard,
+        // which also spreads keys where std::hash is only 32 bits wide.
+        return shards[static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ull) >> 48) % shard_count];
+    }
+};
+
+ConversionCache::ConversionCache(const ConversionCacheOptions& options) : impl_(std::make_unique<Impl>()) {
+    std::size_t shards = options.shards;
+    if (shards == 0) shards = std::max(1u, std::thread::hardware_concurrency());
+    impl_->max_entry_bytes = options.max_entry_bytes;
+    impl_->shard_count = shards;
+    impl_->shard_budget = options.max_bytes / shards;
+    impl_->shards = std::make_unique<CacheShard[]>(shards);
+}
+
+ConversionCache::~ConversionCache() = default;
+
+std::shared_ptr<const std::string> ConversionCache::convert(const std::string_view input,
+                                                            const Encoding& from_encoding,
+                                                            const Encoding& to_encoding) {
+    if (input.size() > impl_->max_entry_bytes) {
+        impl_->bypasses.fetch_add(1, std::memory_order_relaxed);
+        return std::make_shared<const std::string>(utf8ansi::convert_encoding(input, from_encoding, to_encoding));
+    }
+
+    std::uint64_t hash = std::hash<std::string_view>{}(input);
+    hash ^= (std::uint64_t{from_encoding.id()} << 32 | to_encoding.id()) * 0x9E3779B97F4A7C15ull;
+    const CacheKey probe{from_encoding.id(), to_encoding.id(), hash, input};
+    CacheShard& shard = impl_->shard_for(hash);
+
+    {
+        const std::lock_guard lock(shard.mutex);
+        if (const auto it = shard.index.find(probe); it != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            ++shard.hits;
+            return it->second->output;
+        }
+    }
+
+    // Convert outside the lock; a concurrent miss on the same key just converts twice.
+    auto output = std::make_shared<const std::string>(utf8ansi::convert_encoding(input, from_encoding, to_encoding));
+
+    const std::lock_guard lock(shard.mutex);
+    ++shard.misses;
+    if (const auto it = shard.index.find(probe); it != shard.index.end()) {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->output;
+    }
+    shard.lru.push_front(CacheEntry{std::string(input), from_encoding.id(), to_encoding.id(), hash, output});
+    const auto entry = shard.lru.begin();
+    shard.index.emplace(CacheKey{entry->from, entry->to, hash, entry->input}, entry);
+    shard.bytes += entry->charge();
+
+    while (shard.bytes > impl_->shard_budget && !shard.lru.empty()) {
+        const CacheEntry& victim = shard.lru.back();
+        shard.bytes -= victim.charge();
+        shard.index.erase(CacheKey{victim.from, victim.to, victim.hash, victim.input});
+        shard.lru.pop_back();
+        ++shard.evictions;
+    }
+    return output;
+}
+
+std::shared_ptr<const std::string> ConversionCache::big5_to_utf8(const std::string_view big5_bytes) {
+    return convert(big5_bytes, Encoding::big5(), Encoding::utf8());
+}
+
+std::shared_ptr<const std::string> ConversionCache::utf8_to_big5(const std::string_view utf8) {
+    return convert(utf8, Encoding::utf8(), Encoding::big5());
+}
+
+ConversionCacheStats ConversionCache::stats() const {
+    ConversionCacheStats stats;
+    stats.bypasses = impl_->bypasses.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < impl_->shard_count; ++i) {
+        const CacheShard& shard = impl_->shards[i];
+        const std::lock_guard lock(shard.mutex);
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.evictions += shard.evictions;
+        stats.entries += shard.lru.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+void ConversionCache::clear() {
+    for (std::size_t i = 0; i < impl_->shard_count; ++i) {
+        CacheShard& shard = impl_->shards[i];
+        const std::lock_guard lock(shard.mutex);
+        shard.index.clear();
+        shard.lru.clear();
+        shard.bytes = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Shared-memory conversion cache
+// -----------------------------------------------------------------------------
+
+namespace {
+
+static_assert(std::atomic_ref<std::uint64_t>::is_always_lock_free, "seqlock slots need lock-free 64-bit atomics");
+
+// Slot layout, in 64-bit words: sequence (odd while being written), key hash (0 = empty),
+// input/output lengths, then input bytes followed by output bytes.
+constexpr std::size_t kSlotWords = 32;
+constexpr std::size_t kSlotHeaderWords = 3;
+constexpr std::size_t kSlotPayloadBytes = (kSlotWords - kSlotHeaderWords) * sizeof(std::uint64_t);
+static_assert(kSlotPayloadBytes == SharedConversionCache::kMaxEntryBytes);
+constexpr std::size_t kSharedProbe = 4;
+constexpr std::uint64_t kSharedMagic = 0x75386173686d3031ull; // "u8ashm01"
+
+// Segment header words; the magic is published last by the creator. The header is padded to
+// a cache line so that slots stay aligned.
+constexpr std::size_t kHeaderMagic = 0;
+constexpr std::size_t kHeaderSlotWords = 1;
+constexpr std::size_t kHeaderSlots = 2;
+constexpr std::size_t kSharedHeaderWords = 8;
+
+constexpr std::uint64_t stable_hash(std::uint64_t h, const std::string_view bytes) noexcept {
+    for (const char c : bytes) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::uint64_t shared_key_hash(const std::string_view input, const Encoding& from, const Encoding& to) noexcept {
+    std::uint64_t h = 14695981039346656037ull;
+    h = stable_hash(h, from.name());
+    h = stable_hash(h, std::string_view("\0", 1));
+    h = stable_hash(h, to.name());
+    h = stable_hash(h, std::string_view("\0", 1));
+    h = stable_hash(h, input);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h == 0 ? 1 : h;
+}
+
+std::uint64_t load_word(std::uint64_t& word, const std::memory_order order = std::memory_order_relaxed) noexcept {
+    return std::atomic_ref<std::uint64_t>(word).load(order);
+}
+
+void store_word(std::uint64_t& word, const std::uint64_t value,
+                const std::memory_order order = std::memory_order_relaxed) noexcept {
+    std::atomic_ref<std::uint64_t>(word).store(value, order);
+}
+
+} // namespace
+
+struct SharedConversionCache::Impl {
+    void* mapping = nullptr;
+    std::size_t mapping_bytes = 0;
+    std::uint64_t* slots = nullptr;
+    std::size_t slot_mask = 0;
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> contended{0};
+    std::atomic<std::uint64_t> stores{0};
+    std::atomic<std::uint64_t> bypasses{0};
+
+    std::uint64_t* slot(const std::size_t index) const noexcept { return slots + index * kSlotWords; }
+
+    // Copies a consistent snapshot of the slot payload; false if a writer interfered.
+    static bool read_slot(std::uint64_t* slot, const std::uint64_t hash, const std::string_view input,
+                          std::string& out, bool& contended) {
+        const std::uint64_t seq = load_word(slot[0], std::memory_order_acquire);
+        if (seq & 1u) {
+            contended = true;
+            return false;
+        }
+        if (load_word(slot[1]) != hash) return false;
+        const std::uint64_t lengths = load_word(slot[2]);
+        const std::size_t in_len = lengths & 0xffffu;
+        const std::size_t out_len = lengths >> 16;
+        if (in_len != input.size() || in_len + out_len > kSlotPayloadBytes) return false;
+
+        std::array<std::uint64_t, kSlotWords - kSlotHeaderWords> payload;
+        const std::size_t words = (in_len + out_len + 7) / 8;
+        for (std::size_t w = 0; w < words; ++w) payload[w] = load_word(slot[kSlotHeaderWords + w]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (load_word(slot[0]) != seq) {
+            contended = true;
+            return false;
+        }
+        const auto* bytes = reinterpret_cast<const char*>(payload.data());
+        if (std::string_view(bytes, in_len) != input) return false;
+        out.assign(bytes + in_len, out_len);
+        return true;
+    }
+
+    static bool write_slot(std::uint64_t* slot, const std::uint64_t hash, const std::string_view input,
+                           const std::string_view output) {
+        std::uint64_t seq = load_word(slot[0]);
+        if ((seq & 1u) || !std::atomic_ref<std::uint64_t>(slot[0]).compare_exchange_strong(
+                              seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return false; // another writer owns the slot
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::array<std::uint64_t, kSlotWords - kSlotHeaderWords> payload{};
+        auto* bytes = reinterpret_cast<char*>(payload.data());
+        std::copy(input.begin(), input.end(), bytes);
+        std::copy(output.begin(), output.end(), bytes + input.size());
+        const std::size_t words = (input.size() + output.size() + 7) / 8;
+
+        store_word(slot[1], hash);
+        store_word(slot[2], input.size() | output.size() << 16);
+        for (std::size_t w = 0; w < words; ++w) store_word(slot[kSlotHeaderWords + w], payload[w]);
+        store_word(slot[0], seq + 2, std::memory_order_release);
+        return true;
+    }
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+
+SharedConversionCache::SharedConversionCache(const std::string& name, const SharedConversionCacheOptions& options)
+    : impl_(std::make_unique<Impl>()) {
+    const std::size_t slots = std::bit_ceil(std::max<std::size_t>(options.slots, kSharedProbe));
+    const std::size_t bytes = (kSharedHeaderWords + slots * kSlotWords) * sizeof(std::uint64_t);
+    const auto fail = [&](const char* what) {
+        throw std::runtime_error(std::string("SharedConversionCache: ") + what + " failed for " + name + ": "
+                                 + std::strerror(errno));
+    };
+
+    bool created = true;
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        created = false;
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) fail("shm_open");
+    if (created && ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        const int err = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        errno = err;
+        fail("ftruncate");
+    }
+    if (!created) {
+        // The creator may still be sizing the segment.
+        struct stat st {};
+        for (int attempt = 0; attempt < 1000; ++attempt) {
+            if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) >= bytes) break;
+            std::this_thread::yield();
+        }
+        if (static_cast<std::size_t>(st.st_size) != bytes) {
+            close(fd);
+            throw std::runtime_error("SharedConversionCache: segment " + name + " has a different size");
+        }
+    }
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) fail("mmap");
+    impl_->mapping = mapping;
+    impl_->mapping_bytes = bytes;
+
+    auto* header = static_cast<std::uint64_t*>(mapping);
+    if (created) {
+        store_word(header[kHeaderSlotWords], kSlotWords);
+        store_word(header[kHeaderSlots], slots);
+        store_word(header[kHeaderMagic], kSharedMagic, std::memory_order_release);
+    } else {
+        bool ready = false;
+        for (int attempt = 0; attempt < 1000 && !ready; ++attempt) {
+            ready = load_word(header[kHeaderMagic], std::memory_order_acquire) == kSharedMagic;
+            if (!ready) std::this_thread::yield();
+        }
+        if (!ready || load_word(header[kHeaderSlotWords]) != kSlotWords
+            || load_word(header[kHeaderSlots]) != slots) {
+            munmap(mapping, bytes);
+            throw std::runtime_error("SharedConversionCache: segment " + name + " has an incompatible layout");
+        }
+    }
+    impl_->slots = header + kSharedHeaderWords;
+    impl_->slot_mask = slots - 1;
+}
+
+SharedConversionCache::~SharedConversionCache() {
+    if (impl_->mapping) munmap(impl_->mapping, impl_->mapping_bytes);
+}
+
+void SharedConversionCache::remove(const std::string& name) noexcept {
+    shm_unlink(name.c_str());
+}
+
+#else
+
+SharedConversionCache::SharedConversionCache(const std::string&, const SharedConversionCacheOptions&) {
+    throw std::runtime_error("SharedConversionCache requires POSIX shared memory");
+}
+
+SharedConversionCache::~SharedConversionCache() = default;
+
+void SharedConversionCache::remove(const std::string&) noexcept {}
+
+#endif
+
+std::string SharedConversionCache::convert(const std::string_view input, const Encoding& from_encoding,
+                                           const Encoding& to_encoding) {
+    if (input.size() > kMaxEntryBytes) {
+        impl_->bypasses.fetch_add(1, std::memory_order_relaxed);
+        return utf8ansi::convert_encoding(input, from_encoding, to_encoding);
+    }
+
+    const std::uint64_t hash = shared_key_hash(input, from_encoding, to_encoding);
+    const std::size_t home = static_cast<std::size_t>(hash) & impl_->slot_mask;
+    bool contended = false;
+    std::string out;
+    for (std::size_t probe = 0; probe < kSharedProbe; ++probe) {
+        if (Impl::read_slot(impl_->slot((home + probe) & impl_->slot_mask), hash, input, out, contended)) {
+            impl_->hits.fetch_add(1, std::memory_order_relaxed);
+            return out;
+        }
+    }
+    impl_->misses.fetch_add(1, std::memory_order_relaxed);
+
+    out = utf8ansi::convert_encoding(input, from_encoding, to_encoding);
+    if (input.size() + out.size() > kMaxEntryBytes) {
+        impl_->bypasses.fetch_add(1, std::memory_order_relaxed);
+        return out;
+    }
+
+    // Store into the first empty probe slot; when the window is full, overwrite one chosen by
+    // the hash so that hot keys do not keep evicting the same neighbour.
+    std::size_t victim = (home + (hash >> 60) % kSharedProbe) & impl_->slot_mask;
+    for (std::size_t probe = 0; probe < kSharedProbe; ++probe) {
+        const std::size_t index = (home + probe) & impl_->slot_mask;
+        if (load_word(impl_->slot(index)[1]) == 0) {
+            victim = index;
+            break;
+        }
+    }
+    if (Impl::write_slot(impl_->slot(victim), hash, input, out)) {
+        impl_->stores.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        contended = true;
+    }
+    if (contended) impl_->contended.fetch_add(1, std::memory_order_relaxed);
+    return out;
+}
+
+std::string SharedConversionCache::big5_to_utf8(const std::string_view big5_bytes) {
+    return convert(big5_bytes, Encoding::big5(), Encoding::utf8());
+}
+
+std::string SharedConversionCache::utf8_to_big5(const std::string_view utf8) {
+    return convert(utf8, Encoding::utf8(), Encoding::big5());
+}
+
+SharedConversionCacheStats SharedConversionCache::stats() const noexcept {
+    SharedConversionCacheStats stats;
+    stats.hits = impl_->hits.load(std::memory_order_relaxed);
+    stats.misses = impl_->misses.load(std::memory_order_relaxed);
+    stats.contended = impl_->contended.load(std::memory_order_relaxed);
+    stats.stores = impl_->stores.load(std::memory_order_relaxed);
+    stats.bypasses = impl_->bypasses.load(std::memory_order_relaxed);
+    return stats;
 }
 
 } // namespace utf8ansi
\ No newline at end of file
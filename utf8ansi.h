@@ -1,11 +1,90 @@
 #ifndef UTF8_ANSI_CPP_LIBRARY_H
 #define UTF8_ANSI_CPP_LIBRARY_H
 
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <initializer_list>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#define UTF8ANSI_HAS_IOVEC 1
+#else
+#define UTF8ANSI_HAS_IOVEC 0
+#endif
 
 namespace utf8ansi {
 
+namespace detail {
+struct EncodingRecord;
+class SegmentedWriter;
+} // namespace detail
+
+// Capability flags of an encoding, computed once when the encoding is resolved.
+enum class EncodingFlags : std::uint32_t {
+    none = 0,
+    unicode = 1u << 0,          // a Unicode encoding form (UTF-8, UTF-16, UTF-32, ...)
+    utf8 = 1u << 1,             // exactly UTF-8
+    ascii_compatible = 1u << 2, // bytes 0x00-0x7F map one-to-one to U+0000-U+007F
+    single_byte = 1u << 3,      // at most one byte per character
+    stateful = 1u << 4,         // uses shift sequences (ISO-2022, HZ, EBCDIC stateful, ...)
+};
+
+[[nodiscard]] constexpr EncodingFlags operator|(EncodingFlags a, EncodingFlags b) noexcept {
+    return static_cast<EncodingFlags>(static_cast<std::uint32_t>(a) | static_cast<std::uint32_t>(b));
+}
+[[nodiscard]] constexpr EncodingFlags operator&(EncodingFlags a, EncodingFlags b) noexcept {
+    return static_cast<EncodingFlags>(static_cast<std::uint32_t>(a) & static_cast<std::uint32_t>(b));
+}
+
+// A resolved encoding: canonical ICU name, process-wide interned ID and capability flags.
+// Resolving an encoding validates the name once; passing an Encoding to the conversion
+// overloads below performs no name parsing, alias lookup or allocation per call.
+// Encoding is a cheap, trivially copyable value; resolved encodings live for the whole process.
+class Encoding {
+public:
+    // Resolve an ICU encoding name or alias (case-insensitive).
+    // Throws std::runtime_error if ICU does not know the encoding.
+    explicit Encoding(std::string_view name);
+
+    // Pre-resolved encodings used by the convenience helpers.
+    [[nodiscard]] static Encoding utf8();
+    [[nodiscard]] static Encoding big5();
+
+    // ICU canonical name; the view is NUL-terminated and valid for the lifetime of the process.
+    [[nodiscard]] std::string_view name() const noexcept;
+    // Dense interned ID, unique per canonical encoding within this process.
+    [[nodiscard]] std::uint32_t id() const noexcept;
+    [[nodiscard]] EncodingFlags flags() const noexcept;
+    [[nodiscard]] bool has(EncodingFlags flag) const noexcept { return (flags() & flag) == flag; }
+    // Maximum number of bytes per UTF-16 code unit when converting from Unicode.
+    [[nodiscard]] int max_char_size() const noexcept;
+
+    // Implementation detail; the record type is opaque outside the library.
+    [[nodiscard]] const detail::EncodingRecord& record() const noexcept { return *rec_; }
+
+    friend bool operator==(const Encoding& a, const Encoding& b) noexcept { return a.rec_ == b.rec_; }
+
+private:
+    const detail::EncodingRecord* rec_;
+};
+
 // Convert from one encoding to another using ICU.
 // Throws std::runtime_error on failure.
 [[nodiscard]] std::string convert_encoding(std::string_view input,
@@ -21,10 +100,61 @@ namespace utf8ansi {
 [[nodiscard]] std::string utf8_to_big5(std::string_view utf8);
 
 // "Direct" converters that avoid allocating a full UTF-16 intermediate buffer
-// by using ICU's streaming API with a small pivot (ucnv_convertEx).
+// by using ICU's streaming API with a small pivot (ucnv_convertEx). The output buffer is sized
+// by estimate_output_size(), so ASCII-heavy input is not over-allocated 2-3x.
 [[nodiscard]] std::string big5_to_utf8_dr(std::string_view big5_bytes);
 [[nodiscard]] std::string utf8_to_big5_dr(std::string_view utf8);
 
+// Pre-resolved encoding overloads (no per-call name lookup)
+[[nodiscard]] std::string convert_encoding(std::string_view input,
+                             const Encoding& from_encoding,
+                             const Encoding& to_encoding);
+[[nodiscard]] std::string to_utf8(std::string_view input, const Encoding& from_encoding);
+[[nodiscard]] std::string from_utf8(std::string_view utf8, const Encoding& to_encoding);
+
+// std::pmr overloads: the result and all internal scratch buffers (the UTF-16 intermediate,
+// streaming output growth) are allocated from `resource`, e.g. a per-request
+// std::pmr::monotonic_buffer_resource. nullptr selects std::pmr::get_default_resource().
+[[nodiscard]] std::pmr::string convert_encoding(std::string_view input,
+                                  std::string_view from_encoding,
+                                  std::string_view to_encoding,
+                                  std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string convert_encoding(std::string_view input,
+                                  const Encoding& from_encoding,
+                                  const Encoding& to_encoding,
+                                  std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string to_utf8(std::string_view input, std::string_view from_encoding,
+                                  std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string to_utf8(std::string_view input, const Encoding& from_encoding,
+                                  std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string from_utf8(std::string_view utf8, std::string_view to_encoding,
+                                  std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string from_utf8(std::string_view utf8, const Encoding& to_encoding,
+                                  std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string big5_to_utf8(std::string_view big5_bytes, std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string utf8_to_big5(std::string_view utf8, std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string big5_to_utf8_dr(std::string_view big5_bytes, std::pmr::memory_resource* resource);
+[[nodiscard]] std::pmr::string utf8_to_big5_dr(std::string_view utf8, std::pmr::memory_resource* resource);
+
+// In-place conversion for pairs whose output is provably never longer than the input at any
+// prefix: UTF-8 to UTF-8 (validation), and UTF-8 to any ASCII-compatible, stateless encoding with
+// at most 2 bytes per UTF-16 code unit (Big5, GBK, EUC-KR, ISO-8859-x, ...).
+// Output is written over already consumed input, so no second buffer is needed; `buf` is
+// resized to the output length (its capacity is kept).
+// Throws std::invalid_argument if the pair may grow, std::runtime_error on conversion errors
+// (`buf` is then cleared).
+[[nodiscard]] bool can_convert_in_place(const Encoding& from_encoding, const Encoding& to_encoding) noexcept;
+void convert_in_place(std::string& buf, const Encoding& from_encoding, const Encoding& to_encoding);
+void convert_in_place(std::string& buf, std::string_view from_encoding, std::string_view to_encoding);
+void utf8_to_big5_in_place(std::string& buf);
+
+// Predicted output size of converting `input`, from a fast scan counting its non-ASCII bytes.
+// Exact or a slight over-estimate for UTF-8 sources and for Big5 to UTF-8; other pairs get the
+// worst case (input size times the target's maximum bytes per UTF-16 code unit).
+[[nodiscard]] std::size_t estimate_output_size(std::string_view input,
+                                               const Encoding& from_encoding,
+                                               const Encoding& to_encoding) noexcept;
+
 // C-style input overloads (null-terminated)
 [[nodiscard]] std::string convert_encoding(const char* input,
                              std::string_view from_encoding,
@@ -51,6 +181,827 @@ namespace utf8ansi {
 [[nodiscard]] std::string big5_to_utf8_dr(const char* big5_bytes, std::size_t length);
 [[nodiscard]] std::string utf8_to_big5_dr(const char* utf8, std::size_t length);
 
+// -----------------------------------------------------------------------------
+// Scatter-gather input
+// -----------------------------------------------------------------------------
+
+// Convert input that arrives as several non-contiguous fragments (e.g. a parsed message payload)
+// without concatenating them first. The fragments are streamed as one input with converter state
+// carried across boundaries, so a multi-byte character may be split between fragments.
+// Throws std::runtime_error on conversion errors, std::invalid_argument for a null fragment with
+// a non-zero size.
+[[nodiscard]] std::string convert_fragments(std::span<const std::span<const char>> fragments,
+                                            const Encoding& from_encoding,
+                                            const Encoding& to_encoding);
+[[nodiscard]] std::string big5_to_utf8_dr(std::span<const std::span<const char>> fragments);
+[[nodiscard]] std::string utf8_to_big5_dr(std::span<const std::span<const char>> fragments);
+#if UTF8ANSI_HAS_IOVEC
+[[nodiscard]] std::string convert_fragments(std::span<const iovec> fragments,
+                                            const Encoding& from_encoding,
+                                            const Encoding& to_encoding);
+#endif
+
+// -----------------------------------------------------------------------------
+// Output sinks
+// -----------------------------------------------------------------------------
+
+// Anything callable with a block of converted bytes: a socket or file writer, a compression
+// stream, ... Blocks are only valid for the duration of the call.
+template <typename Sink>
+concept OutputSink = std::invocable<Sink&, std::span<const char>>;
+
+inline constexpr std::size_t kDefaultSinkBlockSize = 16 * 1024;
+// Smallest accepted block size: room for any character's output plus a partial flush.
+inline constexpr std::size_t kMinSinkBlockSize = 64;
+
+namespace detail {
+using SinkFn = void (*)(void* context, std::span<const char> block);
+void convert_to_sink(std::span<const std::span<const char>> fragments, const Encoding& from_encoding,
+                     const Encoding& to_encoding, std::size_t block_size, void* context, SinkFn emit);
+} // namespace detail
+
+// Convert `input` and hand the output to `sink` in blocks of `block_size` bytes (the last block
+// may be shorter; nothing is emitted for empty output). Memory use is bounded by the block size
+// however large the output, and output is never copied into a growing string.
+// Throws std::invalid_argument if `block_size` is below kMinSinkBlockSize, std::runtime_error on
+// conversion errors (blocks already emitted stay emitted), and propagates anything thrown by the
+// sink.
+template <OutputSink Sink>
+void convert_encoding_to(std::string_view input,
+                         const Encoding& from_encoding,
+                         const Encoding& to_encoding,
+                         Sink&& sink,
+                         std::size_t block_size = kDefaultSinkBlockSize) {
+    using SinkType = std::remove_reference_t<Sink>;
+    void* const context = const_cast<void*>(static_cast<const void*>(std::addressof(sink)));
+    const std::span<const char> fragment(input.data(), input.size());
+    detail::convert_to_sink(std::span(&fragment, 1), from_encoding, to_encoding, block_size, context,
+                            [](void* ctx, std::span<const char> block) { (*static_cast<SinkType*>(ctx))(block); });
+}
+
+// Scatter-gather form: the fragments are converted as one continuous input.
+template <OutputSink Sink>
+void convert_fragments_to(std::span<const std::span<const char>> fragments,
+                          const Encoding& from_encoding,
+                          const Encoding& to_encoding,
+                          Sink&& sink,
+                          std::size_t block_size = kDefaultSinkBlockSize) {
+    using SinkType = std::remove_reference_t<Sink>;
+    void* const context = const_cast<void*>(static_cast<const void*>(std::addressof(sink)));
+    detail::convert_to_sink(fragments, from_encoding, to_encoding, block_size, context,
+                            [](void* ctx, std::span<const char> block) { (*static_cast<SinkType*>(ctx))(block); });
+}
+
+template <OutputSink Sink>
+void big5_to_utf8_to(std::string_view big5_bytes, Sink&& sink, std::size_t block_size = kDefaultSinkBlockSize) {
+    convert_encoding_to(big5_bytes, Encoding::big5(), Encoding::utf8(), std::forward<Sink>(sink), block_size);
+}
+
+template <OutputSink Sink>
+void utf8_to_big5_to(std::string_view utf8, Sink&& sink, std::size_t block_size = kDefaultSinkBlockSize) {
+    convert_encoding_to(utf8, Encoding::utf8(), Encoding::big5(), std::forward<Sink>(sink), block_size);
+}
+
+// -----------------------------------------------------------------------------
+// Chunk generators
+// -----------------------------------------------------------------------------
+
+// A lazily evaluated, single-pass sequence of converted output chunks (a C++20 coroutine).
+// Conversion advances only as the consumer pulls the next chunk, so it can be pipelined with
+// parsing or compression, and abandoning the loop early (e.g. after the first N lines) skips
+// the rest of the input. Each chunk is valid until the iterator is incremented. Conversion
+// errors are thrown from begin() or operator++.
+class ChunkGenerator {
+public:
+    struct promise_type {
+        std::span<const char> chunk;
+        std::exception_ptr error;
+
+        ChunkGenerator get_return_object() noexcept {
+            return ChunkGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_always final_suspend() const noexcept { return {}; }
+        std::suspend_always yield_value(std::span<const char> next) noexcept {
+            chunk = next;
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    class iterator {
+    public:
+        using value_type = std::span<const char>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+        explicit iterator(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+        [[nodiscard]] value_type operator*() const noexcept { return handle_.promise().chunk; }
+        iterator& operator++() {
+            advance(handle_);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+            return !it.handle_ || it.handle_.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    ChunkGenerator(ChunkGenerator&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    ChunkGenerator& operator=(ChunkGenerator&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ChunkGenerator(const ChunkGenerator&) = delete;
+    ChunkGenerator& operator=(const ChunkGenerator&) = delete;
+    ~ChunkGenerator() {
+        if (handle_) handle_.destroy();
+    }
+
+    // Produces the first chunk; call once.
+    [[nodiscard]] iterator begin() {
+        advance(handle_);
+        return iterator(handle_);
+    }
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    explicit ChunkGenerator(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    static void advance(const std::coroutine_handle<promise_type> handle) {
+        if (!handle || handle.done()) return;
+        handle.resume();
+        if (handle.done() && handle.promise().error) std::rethrow_exception(std::exchange(handle.promise().error, {}));
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Chunks of converting `input` (which must outlive the generator), at most `chunk_size` bytes each.
+// The encodings are taken by value because the coroutine outlives the call. Throws
+// std::invalid_argument (from the call itself) if `chunk_size` is below kMinSinkBlockSize.
+[[nodiscard]] ChunkGenerator convert_chunks(std::string_view input,
+                                            Encoding from_encoding,
+                                            Encoding to_encoding,
+                                            std::size_t chunk_size = kDefaultSinkBlockSize);
+// Chunks of converting everything read from `in` (which must outlive the generator). Input is
+// read in blocks of `chunk_size` bytes only as output is pulled.
+[[nodiscard]] ChunkGenerator convert_chunks(std::istream& in,
+                                            Encoding from_encoding,
+                                            Encoding to_encoding,
+                                            std::size_t chunk_size = kDefaultSinkBlockSize);
+
+// -----------------------------------------------------------------------------
+// Lazy transcoding views
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+// Incremental converter shared by convert_chunks() and views::transcode: feed input with
+// start_input(), then call convert() until it returns false, taking each full chunk in between.
+class Transcoder {
+public:
+    Transcoder(const Encoding& from_encoding, const Encoding& to_encoding, std::size_t chunk_size);
+    Transcoder(Transcoder&&) noexcept;
+    Transcoder& operator=(Transcoder&&) noexcept;
+    ~Transcoder();
+
+    // `data` must stay valid until convert() has returned false; `last` flushes at its end.
+    void start_input(const char* data, std::size_t size, bool last) noexcept;
+    // True when the chunk buffer is full (take it and call again), false once the input is consumed.
+    bool convert();
+    [[nodiscard]] bool has_output() const noexcept;
+    // The converted bytes so far; valid until the next convert().
+    std::span<const char> take_chunk() noexcept;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+template <class T>
+concept ByteLike = sizeof(T) == 1 && (std::integral<T> || std::same_as<T, std::byte>);
+
+} // namespace detail
+
+// An input view of the bytes of `base` converted from one encoding to another. Conversion runs
+// one chunk at a time as the view is iterated, so it composes with std::views::take,
+// std::views::lazy_split and friends without converting more input than is consumed. Like other
+// single-pass views, begin() may be called only once. Conversion errors are thrown from begin()
+// or operator++.
+template <std::ranges::view V>
+    requires std::ranges::input_range<V> && detail::ByteLike<std::ranges::range_value_t<V>>
+class transcode_view : public std::ranges::view_interface<transcode_view<V>> {
+    static constexpr std::size_t kChunkSize = 4096;
+
+    struct State {
+        State(V& base, const Encoding& from_encoding, const Encoding& to_encoding)
+            : transcoder(from_encoding, to_encoding, kChunkSize),
+              current(std::ranges::begin(base)),
+              last(std::ranges::end(base)) {}
+
+        detail::Transcoder transcoder;
+        std::ranges::iterator_t<V> current;
+        std::ranges::sentinel_t<V> last;
+        std::vector<char> staging;
+        std::span<const char> chunk;
+        std::size_t position = 0;
+        bool input_done = false;
+        bool flushed = false;
+
+        // Points the transcoder at the next piece of input; contiguous bases are fed in one go.
+        void feed() {
+            if constexpr (std::ranges::contiguous_range<V> && std::sized_sentinel_for<std::ranges::sentinel_t<V>,
+                                                                                      std::ranges::iterator_t<V>>) {
+                const auto size = static_cast<std::size_t>(last - current);
+                transcoder.start_input(reinterpret_cast<const char*>(std::to_address(current)), size, true);
+                current = std::ranges::next(current, last);
+                input_done = true;
+            } else {
+                staging.clear();
+                for (; current != last && staging.size() < kChunkSize; ++current) {
+                    staging.push_back(static_cast<char>(static_cast<unsigned char>(*current)));
+                }
+                input_done = current == last;
+                transcoder.start_input(staging.data(), staging.size(), input_done);
+            }
+        }
+
+        // Makes `chunk` the next non-empty run of output; leaves it empty at the end.
+        void next_chunk() {
+            chunk = {};
+            position = 0;
+            while (!flushed) {
+                if (transcoder.convert()) {
+                    chunk = transcoder.take_chunk();
+                    if (!chunk.empty()) return;
+                    continue;
+                }
+                if (input_done) {
+                    flushed = true;
+                    chunk = transcoder.take_chunk();
+                    return;
+                }
+                feed();
+            }
+        }
+    };
+
+public:
+    class iterator {
+    public:
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+        explicit iterator(State* state) noexcept : state_(state) {}
+
+        [[nodiscard]] char operator*() const noexcept { return state_->chunk[state_->position]; }
+        iterator& operator++() {
+            if (++state_->position == state_->chunk.size()) state_->next_chunk();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+            return it.state_->chunk.empty();
+        }
+
+    private:
+        State* state_ = nullptr;
+    };
+
+    transcode_view()
+        requires std::default_initializable<V>
+    = default;
+    transcode_view(V base, const Encoding& from_encoding, const Encoding& to_encoding)
+        : base_(std::move(base)), from_(from_encoding), to_(to_encoding) {}
+
+    [[nodiscard]] V base() const&
+        requires std::copy_constructible<V>
+    {
+        return base_;
+    }
+    [[nodiscard]] V base() && { return std::move(base_); }
+
+    [[nodiscard]] iterator begin() {
+        state_ = std::make_unique<State>(base_, from_, to_);
+        state_->feed();
+        state_->next_chunk();
+        return iterator(state_.get());
+    }
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    V base_{};
+    Encoding from_ = Encoding::utf8();
+    Encoding to_ = Encoding::utf8();
+    std::unique_ptr<State> state_;
+};
+
+template <class R>
+transcode_view(R&&, const Encoding&, const Encoding&) -> transcode_view<std::views::all_t<R>>;
+
+namespace views {
+
+// The pipeable half of views::transcode(from, to).
+struct TranscodeClosure {
+    Encoding from_encoding;
+    Encoding to_encoding;
+
+    template <std::ranges::viewable_range R>
+    [[nodiscard]] friend auto operator|(R&& range, const TranscodeClosure& closure) {
+        return transcode_view(std::forward<R>(range), closure.from_encoding, closure.to_encoding);
+    }
+};
+
+struct TranscodeFn {
+    // `bytes | views::transcode(from, to)`
+    [[nodiscard]] TranscodeClosure operator()(const Encoding& from_encoding, const Encoding& to_encoding) const {
+        return {from_encoding, to_encoding};
+    }
+    // `views::transcode(bytes, from, to)`
+    template <std::ranges::viewable_range R>
+    [[nodiscard]] auto operator()(R&& range, const Encoding& from_encoding, const Encoding& to_encoding) const {
+        return transcode_view(std::forward<R>(range), from_encoding, to_encoding);
+    }
+};
+
+// Lazily converts a range of bytes, e.g.
+//   for (auto line : input | utf8ansi::views::transcode(Encoding::big5(), Encoding::utf8())
+//                          | std::views::lazy_split('\n') | std::views::take(3)) ...
+inline constexpr TranscodeFn transcode{};
+
+} // namespace views
+
+// -----------------------------------------------------------------------------
+// Segmented output
+// -----------------------------------------------------------------------------
+
+// Converted output held as a list of fixed-size blocks (a rope) instead of one contiguous
+// string: large outputs are never reallocated or copied, and the blocks can be handed to
+// writev() as they are. Blocks come from a process-wide pool and return to it on destruction.
+class SegmentedOutput {
+public:
+    static constexpr std::size_t kBlockSize = std::size_t{64} << 10;
+
+    SegmentedOutput() noexcept = default;
+    SegmentedOutput(SegmentedOutput&& other) noexcept;
+    SegmentedOutput& operator=(SegmentedOutput&& other) noexcept;
+    SegmentedOutput(const SegmentedOutput&) = delete;
+    SegmentedOutput& operator=(const SegmentedOutput&) = delete;
+    ~SegmentedOutput();
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    // The filled part of each block, in order; no block is empty.
+    [[nodiscard]] std::span<const std::span<const char>> blocks() const noexcept { return blocks_; }
+#if UTF8ANSI_HAS_IOVEC
+    // One entry per block, ready for writev() (split the array if it exceeds IOV_MAX).
+    [[nodiscard]] std::vector<iovec> iovecs() const;
+#endif
+    // Copy into one contiguous string.
+    [[nodiscard]] std::string str() const;
+
+private:
+    friend class detail::SegmentedWriter;
+
+    void release() noexcept;
+
+    std::vector<std::span<const char>> blocks_;
+    std::size_t size_ = 0;
+};
+
+// Convert into pooled blocks. Throws std::runtime_error on conversion errors.
+[[nodiscard]] SegmentedOutput convert_segmented(std::string_view input,
+                                                const Encoding& from_encoding,
+                                                const Encoding& to_encoding);
+[[nodiscard]] SegmentedOutput big5_to_utf8_segmented(std::string_view big5_bytes);
+[[nodiscard]] SegmentedOutput utf8_to_big5_segmented(std::string_view utf8);
+
+// -----------------------------------------------------------------------------
+// Mapped output
+// -----------------------------------------------------------------------------
+
+// Growable contiguous buffer backed by an anonymous memory mapping. On Linux growth is an
+// mremap() page-table operation, so data already written is never copied however large the
+// buffer gets; elsewhere it falls back to realloc().
+class MappedBuffer {
+public:
+    MappedBuffer() noexcept = default;
+    // Throws std::bad_alloc if the mapping fails.
+    explicit MappedBuffer(std::size_t capacity);
+    MappedBuffer(MappedBuffer&& other) noexcept;
+    MappedBuffer& operator=(MappedBuffer&& other) noexcept;
+    MappedBuffer(const MappedBuffer&) = delete;
+    MappedBuffer& operator=(const MappedBuffer&) = delete;
+    ~MappedBuffer();
+
+    [[nodiscard]] char* data() noexcept { return data_; }
+    [[nodiscard]] const char* data() const noexcept { return data_; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] std::string_view view() const noexcept { return {data_, size_}; }
+    [[nodiscard]] std::string str() const { return std::string(view()); }
+
+    // Grow the capacity to at least `capacity` bytes, keeping the contents.
+    // Throws std::bad_alloc if the mapping cannot grow.
+    void reserve(std::size_t capacity);
+    // Set the size, growing the capacity if needed. Bytes past the old size are unspecified.
+    void resize(std::size_t size);
+
+private:
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+// Streaming conversion into a MappedBuffer, for very large outputs that should neither be
+// copied while growing nor copied out into a std::string afterwards.
+// Throws std::runtime_error on conversion errors.
+[[nodiscard]] MappedBuffer convert_mapped(std::string_view input,
+                                          const Encoding& from_encoding,
+                                          const Encoding& to_encoding);
+[[nodiscard]] MappedBuffer big5_to_utf8_mapped(std::string_view big5_bytes);
+[[nodiscard]] MappedBuffer utf8_to_big5_mapped(std::string_view utf8);
+
+// -----------------------------------------------------------------------------
+// Batch conversion
+// -----------------------------------------------------------------------------
+
+// Result of a deduplicated batch: each distinct input is converted once into `values`, and
+// `index[i]` names the value for input i.
+struct DedupedBatch {
+    std::vector<std::string> values;
+    std::vector<std::uint32_t> index;
+
+    [[nodiscard]] std::size_t size() const noexcept { return index.size(); }
+    [[nodiscard]] const std::string& operator[](std::size_t i) const { return values[index[i]]; }
+};
+
+// Convert a batch of values (e.g. a column). Identical inputs are detected (hash + compare)
+// and converted only once. Throws std::runtime_error if any value fails to convert.
+[[nodiscard]] DedupedBatch convert_batch_deduplicated(std::span<const std::string_view> inputs,
+                                                      const Encoding& from_encoding,
+                                                      const Encoding& to_encoding);
+// Same, fanned out to one string per input.
+[[nodiscard]] std::vector<std::string> convert_batch(std::span<const std::string_view> inputs,
+                                                     const Encoding& from_encoding,
+                                                     const Encoding& to_encoding);
+[[nodiscard]] std::vector<std::string> big5_to_utf8_batch(std::span<const std::string_view> big5_values);
+[[nodiscard]] std::vector<std::string> utf8_to_big5_batch(std::span<const std::string_view> utf8_values);
+
+// -----------------------------------------------------------------------------
+// Deferred conversion
+// -----------------------------------------------------------------------------
+
+// Holds source bytes and an encoding pair and converts only on first access, caching the
+// result (or the conversion error, rethrown on every access). get() is thread-safe: concurrent
+// first calls convert once and the others wait for the result. Moving an object while another
+// thread is inside get() is undefined.
+class lazy_converted {
+public:
+    lazy_converted(std::string source, const Encoding& from_encoding, const Encoding& to_encoding);
+    [[nodiscard]] static lazy_converted from_big5(std::string big5_bytes);
+
+    lazy_converted(lazy_converted&& other) noexcept;
+    lazy_converted& operator=(lazy_converted&& other) noexcept;
+    lazy_converted(const lazy_converted&) = delete;
+    lazy_converted& operator=(const lazy_converted&) = delete;
+
+    // Converts on first call. Throws std::runtime_error if the source does not convert.
+    [[nodiscard]] const std::string& get() const;
+    // True once a conversion has finished (successfully or not).
+    [[nodiscard]] bool converted() const noexcept;
+
+    [[nodiscard]] std::string_view source() const noexcept { return source_; }
+    [[nodiscard]] const Encoding& from_encoding() const noexcept { return from_; }
+    [[nodiscard]] const Encoding& to_encoding() const noexcept { return to_; }
+
+private:
+    enum : std::uint8_t { kPending, kRunning, kDone, kFailed };
+
+    std::string source_;
+    Encoding from_;
+    Encoding to_;
+    mutable std::atomic<std::uint8_t> state_{kPending};
+    mutable std::string result_;
+    mutable std::exception_ptr error_;
+};
+
+// -----------------------------------------------------------------------------
+// Converter caching
+// -----------------------------------------------------------------------------
+
+// How conversions obtain ICU converters.
+enum class ConverterCaching {
+    // Clone a converter from the encoding's prototype for every call (default).
+    // Costs no retained memory per thread.
+    clone,
+    // Check converters out of a bounded, per-CPU-sharded, lock-free pool per encoding and
+    // return them afterwards. Suited to many short-lived threads, where thread-local caches
+    // would multiply converter memory by the thread count.
+    pooled,
+};
+
+struct ConverterPoolOptions {
+    std::size_t shards = 0;             // 0 = one shard per hardware thread
+    std::size_t per_shard_capacity = 4; // converters retained per shard
+};
+
+struct ConverterPoolStats {
+    std::uint64_t hits = 0;     // checkouts served from the pool
+    std::uint64_t misses = 0;   // checkouts that had to clone a new converter
+    std::uint64_t discards = 0; // returns dropped because the shard was full
+    std::size_t depth = 0;      // converters currently idle in the pool
+    std::size_t capacity = 0;   // maximum idle converters (shards * per_shard_capacity)
+
+    [[nodiscard]] double hit_rate() const noexcept {
+        const auto total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+void set_converter_caching(ConverterCaching caching) noexcept;
+[[nodiscard]] ConverterCaching converter_caching() noexcept;
+
+// Applies to pools created afterwards; configure before the first pooled conversion.
+void set_converter_pool_options(const ConverterPoolOptions& options);
+[[nodiscard]] ConverterPoolOptions converter_pool_options();
+
+// Statistics of one encoding's pool; all zero if the encoding was never used in pooled mode.
+[[nodiscard]] ConverterPoolStats converter_pool_stats(const Encoding& encoding);
+
+// -----------------------------------------------------------------------------
+// Per-thread scratch buffers
+// -----------------------------------------------------------------------------
+
+// The two-pass converters (convert_encoding, to_utf8, from_utf8, big5_to_utf8, utf8_to_big5)
+// need a UTF-16 buffer as large as the whole input. Each thread keeps its largest such buffer
+// (its high-water mark) and reuses it, so repeated conversions run on warmed memory.
+struct ScratchBufferOptions {
+    // Largest buffer a thread retains between calls. Conversions that need more get a
+    // one-off buffer that is freed right away.
+    std::size_t max_retained_bytes = std::size_t{1} << 20;
+    // Shrink a retained buffer to the size actually needed after this many consecutive calls
+    // that used at most a quarter of it (0 = keep the high-water buffer until the thread exits).
+    std::uint32_t trim_after_calls = 64;
+};
+
+struct ScratchBufferStats {
+    std::size_t thread_bytes = 0;   // retained by the calling thread
+    std::size_t total_bytes = 0;    // retained by all threads
+    std::size_t threads = 0;        // threads currently holding a scratch buffer
+    std::uint64_t reuses = 0;       // conversions served by a retained buffer
+    std::uint64_t allocations = 0;  // conversions that had to allocate (growth or above the cap)
+};
+
+void set_scratch_buffer_options(const ScratchBufferOptions& options) noexcept;
+[[nodiscard]] ScratchBufferOptions scratch_buffer_options() noexcept;
+[[nodiscard]] ScratchBufferStats scratch_buffer_stats() noexcept;
+// Free the calling thread's retained buffer.
+void release_thread_scratch_buffer() noexcept;
+
+// -----------------------------------------------------------------------------
+// Streaming engine tuning
+// -----------------------------------------------------------------------------
+
+// The streaming converters (_dr, sinks, fragments, segmented and mapped output) pass text through
+// a UTF-16 pivot buffer in ucnv_convertEx. A larger pivot means fewer ICU round trips, a smaller
+// one stays cache-resident. bench_pivot_size sweeps both to find the sweet spot per machine.
+struct StreamingOptions {
+    // UTF-16 code units per pivot, clamped to [64, 65536]; 0 = choose by input size.
+    std::size_t pivot_units = 0;
+};
+
+void set_streaming_options(const StreamingOptions& options) noexcept;
+[[nodiscard]] StreamingOptions streaming_options() noexcept;
+
+// -----------------------------------------------------------------------------
+// Huge pages
+// -----------------------------------------------------------------------------
+
+// Very large conversions spend much of their time faulting in fresh 4 KiB pages. Output strings
+// and UTF-16 scratch buffers of at least `threshold_bytes` are backed by 2 MiB transparent huge
+// pages where the platform supports it (Linux, madvise(MADV_HUGEPAGE)); elsewhere this is a no-op.
+struct HugePageOptions {
+    bool enabled = true;
+    std::size_t threshold_bytes = std::size_t{16} << 20;
+};
+
+void set_huge_page_options(const HugePageOptions& options) noexcept;
+[[nodiscard]] HugePageOptions huge_page_options() noexcept;
+
+// Memory resource handing out 2 MiB-aligned, huge-page backed mappings for allocations of at
+// least 2 MiB (smaller ones go to new/delete), e.g. for the std::pmr overloads. Thread-safe and
+// valid for the lifetime of the process.
+[[nodiscard]] std::pmr::memory_resource* huge_page_resource() noexcept;
+
+// -----------------------------------------------------------------------------
+// Memory budget
+// -----------------------------------------------------------------------------
+
+// Caps the memory a single conversion may allocate (output plus heap scratch buffers, counting
+// both buffers while output is being grown; fixed-size stack buffers are not counted). A
+// conversion that would cross the budget throws MemoryBudgetExceeded instead of risking an OOM
+// kill, however short its input. Where the input proves a minimum output size (UTF-8 sources,
+// Big5 to UTF-8), the streaming (_dr), mapped and segmented converters check it up front and
+// fail before allocating or converting anything. Otherwise they shrink their initial estimate
+// and growth steps to fit, and fail at the growth step that would cross the budget. Sink output,
+// chunk generators and transcoding views hold one bounded block and are not limited; use them
+// to convert inputs whose output exceeds the budget.
+inline constexpr std::size_t kUnlimitedMemoryBudget = 0;
+
+class MemoryBudgetExceeded : public std::runtime_error {
+public:
+    MemoryBudgetExceeded(std::size_t requested, std::size_t budget);
+
+    // Bytes the conversion would have held at once, and the budget in force.
+    [[nodiscard]] std::size_t requested() const noexcept { return requested_; }
+    [[nodiscard]] std::size_t budget() const noexcept { return budget_; }
+
+private:
+    std::size_t requested_;
+    std::size_t budget_;
+};
+
+// Process-wide budget per conversion (kUnlimitedMemoryBudget = no limit, the default).
+void set_memory_budget(std::size_t bytes) noexcept;
+[[nodiscard]] std::size_t memory_budget() noexcept;
+
+// Overrides the budget for conversions on the calling thread while in scope (e.g. per request).
+// Scopes nest; each restores the previous setting.
+class ScopedMemoryBudget {
+public:
+    explicit ScopedMemoryBudget(std::size_t bytes) noexcept;
+    ~ScopedMemoryBudget();
+    ScopedMemoryBudget(const ScopedMemoryBudget&) = delete;
+    ScopedMemoryBudget& operator=(const ScopedMemoryBudget&) = delete;
+
+private:
+    std::size_t previous_;
+};
+
+// -----------------------------------------------------------------------------
+// Warm-up
+// -----------------------------------------------------------------------------
+
+// Resolve the encodings, create their prototype converters and page in their conversion
+// tables by round-tripping every mappable code point, so the first real conversion does
+// not pay ICU's data loading. In pooled mode the pools are filled as well.
+// Throws std::runtime_error if an encoding is unknown.
+void preload(std::initializer_list<std::string_view> encodings);
+
+// Same as preload(), run on a background thread. Errors surface from future::get().
+// The future's destructor waits for the warm-up to finish.
+[[nodiscard]] std::future<void> preload_async(std::vector<std::string> encodings);
+
+// Initialization modes for multi-process servers.
+enum class InitMode {
+    // Only resolve (validate) the given encodings; data is loaded on first use.
+    lazy,
+    // Pre-fork: resolve and preload() the given encodings plus every built-in common encoding
+    // (see "Encoding names" in the README) in the calling process. Call in the parent before
+    // fork() while no other thread is converting, so worker children share the converter data,
+    // prototypes and pools copy-on-write instead of each loading a private copy.
+    prefork,
+};
+
+// Throws std::runtime_error if one of the given encodings is unknown.
+void initialize(InitMode mode, std::initializer_list<std::string_view> encodings = {});
+
+// -----------------------------------------------------------------------------
+// Asynchronous conversion
+// -----------------------------------------------------------------------------
+
+// Large conversions run on a fixed pool of library worker threads (started on first use), so
+// event-loop threads never block on them and no thread is spawned per call. The caller's
+// memory budget (including a ScopedMemoryBudget) applies to the conversion.
+struct AsyncOptions {
+    // Worker threads; 0 = half the hardware threads (at least one).
+    std::size_t threads = 0;
+};
+
+// Takes effect when the pool starts; later calls have no effect.
+void set_async_options(const AsyncOptions& options) noexcept;
+
+// Streaming conversion of `input` on the worker pool. Conversion errors (std::runtime_error,
+// MemoryBudgetExceeded) surface from future::get().
+[[nodiscard]] std::future<std::string> convert_async(std::string input,
+                                                     const Encoding& from_encoding,
+                                                     const Encoding& to_encoding);
+[[nodiscard]] std::future<std::string> big5_to_utf8_async(std::string big5_bytes);
+[[nodiscard]] std::future<std::string> utf8_to_big5_async(std::string utf8);
+
+// -----------------------------------------------------------------------------
+// Conversion cache
+// -----------------------------------------------------------------------------
+
+// Memoizes conversions of repeated values (city names, categories, status strings, ...).
+// Entries are keyed by (from encoding, to encoding, input bytes) and evicted least recently
+// used per shard once the byte budget is exceeded. Results are shared, immutable strings.
+struct ConversionCacheOptions {
+    // Total budget for cached inputs, outputs and per-entry bookkeeping.
+    std::size_t max_bytes = std::size_t{16} << 20;
+    // Inputs longer than this are converted without being cached.
+    std::size_t max_entry_bytes = 4096;
+    // Independently locked LRU shards (0 = one per hardware thread).
+    std::size_t shards = 0;
+};
+
+struct ConversionCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;     // conversions performed and inserted
+    std::uint64_t bypasses = 0;   // inputs above max_entry_bytes
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+
+    [[nodiscard]] double hit_rate() const noexcept {
+        const auto total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+// Thread-safe. Conversion errors propagate as std::runtime_error and are not cached.
+class ConversionCache {
+public:
+    explicit ConversionCache(const ConversionCacheOptions& options = {});
+    ~ConversionCache();
+    ConversionCache(const ConversionCache&) = delete;
+    ConversionCache& operator=(const ConversionCache&) = delete;
+
+    [[nodiscard]] std::shared_ptr<const std::string> convert(std::string_view input,
+                                                             const Encoding& from_encoding,
+                                                             const Encoding& to_encoding);
+    [[nodiscard]] std::shared_ptr<const std::string> big5_to_utf8(std::string_view big5_bytes);
+    [[nodiscard]] std::shared_ptr<const std::string> utf8_to_big5(std::string_view utf8);
+
+    [[nodiscard]] ConversionCacheStats stats() const;
+    void clear();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Cross-process memoization of short conversions: a fixed-size open-addressing table in a
+// named POSIX shared-memory segment, so a value converted by one worker process is reused by
+// all others mapping the same segment. Readers and writers never block: each slot is guarded
+// by a sequence counter, and a slot being written concurrently is treated as a miss.
+// Keys are derived from canonical encoding names and input bytes, so they are stable across
+// processes. Only entries whose input plus output fit kMaxEntryBytes are stored.
+struct SharedConversionCacheOptions {
+    // Number of slots (rounded up to a power of two); each takes 256 bytes of shared memory.
+    std::size_t slots = std::size_t{1} << 16;
+};
+
+struct SharedConversionCacheStats {
+    // Counted per process (per cache object).
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t contended = 0; // lookups or stores skipped because a slot was being written
+    std::uint64_t stores = 0;
+    std::uint64_t bypasses = 0;  // entries too large for a slot
+};
+
+class SharedConversionCache {
+public:
+    static constexpr std::size_t kMaxEntryBytes = 232;
+
+    // Maps the segment `name` (e.g. "/myapp-utf8ansi"), creating it if it does not exist.
+    // Throws std::runtime_error if the segment cannot be created or mapped, if an existing
+    // segment has a different layout, or on platforms without POSIX shared memory.
+    explicit SharedConversionCache(const std::string& name, const SharedConversionCacheOptions& options = {});
+    ~SharedConversionCache(); // unmaps; the segment persists until remove()
+    SharedConversionCache(const SharedConversionCache&) = delete;
+    SharedConversionCache& operator=(const SharedConversionCache&) = delete;
+
+    // Unlink the named segment; processes that still map it keep their mapping.
+    static void remove(const std::string& name) noexcept;
+
+    [[nodiscard]] std::string convert(std::string_view input, const Encoding& from_encoding,
+                                      const Encoding& to_encoding);
+    [[nodiscard]] std::string big5_to_utf8(std::string_view big5_bytes);
+    [[nodiscard]] std::string utf8_to_big5(std::string_view utf8);
+
+    [[nodiscard]] SharedConversionCacheStats stats() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 } // namespace utf8ansi
 
 #endif // UTF8_ANSI_CPP_LIBRARY_H
\ No newline at end of file